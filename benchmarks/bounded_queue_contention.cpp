@@ -0,0 +1,112 @@
+#include <common_library/concurrency/bounded_shared_queue.hpp>
+#include <common_library/concurrency/multi_producer_multi_consumer_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t QUEUE_SIZE = 1'024;
+constexpr std::uint64_t NUM_OPERATIONS = 1'000'000;
+constexpr int THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+
+// Splits NUM_OPERATIONS pushes over num_threads / 2 producers and the matching pops over num_threads / 2 consumers,
+// returning the throughput in ops/sec. With a single thread, the thread alternates between pushing and popping.
+template <typename Queue> double measureThroughput(int num_threads)
+{
+    Queue queue(QUEUE_SIZE);
+
+    if (num_threads == 1)
+    {
+        const auto t1 = std::chrono::steady_clock::now();
+        std::uint64_t value;
+        for (std::uint64_t i = 0; i < NUM_OPERATIONS; ++i)
+        {
+            (void)queue.tryPush(i);
+            (void)queue.tryPop(value);
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+        return static_cast<double>(NUM_OPERATIONS) / std::chrono::duration<double>(t2 - t1).count();
+    }
+
+    const int num_producers = num_threads / 2;
+    const int num_consumers = num_threads - num_producers;
+    const std::uint64_t operations_per_producer = NUM_OPERATIONS / num_producers;
+    const std::uint64_t total_operations = operations_per_producer * num_producers;
+
+    std::atomic<std::uint64_t> popped{0};
+    std::atomic_bool start{false};
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < num_producers; ++p)
+    {
+        threads.emplace_back([&queue, &start, operations_per_producer]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            for (std::uint64_t i = 0; i < operations_per_producer; ++i)
+            {
+                while (!queue.tryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int c = 0; c < num_consumers; ++c)
+    {
+        threads.emplace_back([&queue, &start, &popped, total_operations]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            std::uint64_t value;
+            while (popped.load(std::memory_order_relaxed) < total_operations)
+            {
+                if (queue.tryPop(value))
+                {
+                    popped.fetch_add(1U, std::memory_order_relaxed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    return static_cast<double>(total_operations) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+int main()
+{
+    std::cout << std::setw(8) << "threads" << std::setw(30) << "BoundedSharedQueue [Mops/s]" << std::setw(42)
+              << "MultiProducerMultiConsumerQueue [Mops/s]" << std::endl;
+
+    for (const int num_threads : THREAD_COUNTS)
+    {
+        const double mutex_queue =
+            measureThroughput<common_library::concurrency::BoundedSharedQueue<std::uint64_t>>(num_threads);
+        const double lock_free_queue =
+            measureThroughput<common_library::concurrency::MultiProducerMultiConsumerQueue<std::uint64_t>>(
+                num_threads);
+
+        std::cout << std::setw(8) << num_threads << std::setw(30) << mutex_queue / 1e6 << std::setw(42)
+                  << lock_free_queue / 1e6 << std::endl;
+    }
+
+    return 0;
+}
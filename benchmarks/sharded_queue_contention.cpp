@@ -0,0 +1,94 @@
+#include <common_library/concurrency/sharded_thread_safe_queue.hpp>
+#include <common_library/concurrency/thread_safe_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+constexpr std::uint64_t NUM_OPERATIONS = 1'000'000;
+constexpr int THREAD_COUNTS[] = {2, 4, 8, 16, 32};
+
+// Splits NUM_OPERATIONS pushes over num_threads / 2 producers and the matching pops over num_threads / 2 consumers,
+// which block in pop() while the queue is empty, and returns the throughput in ops/sec. The consumers stop when the
+// queue is closed.
+template <typename Queue> double measureThroughput(Queue &queue, int num_threads)
+{
+    const int num_producers = num_threads / 2;
+    const int num_consumers = num_threads - num_producers;
+    const std::uint64_t operations_per_producer = NUM_OPERATIONS / num_producers;
+    const std::uint64_t total_operations = operations_per_producer * num_producers;
+
+    std::atomic<std::uint64_t> popped{0};
+    std::atomic_bool start{false};
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+
+    for (int p = 0; p < num_producers; ++p)
+    {
+        producers.emplace_back([&queue, &start, operations_per_producer]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            for (std::uint64_t i = 0; i < operations_per_producer; ++i)
+            {
+                queue.push(i);
+            }
+        });
+    }
+
+    for (int c = 0; c < num_consumers; ++c)
+    {
+        consumers.emplace_back([&queue, &popped]() {
+            std::uint64_t count = 0U;
+            while (queue.pop())
+            {
+                ++count;
+            }
+            popped.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    queue.close();
+    for (auto &consumer : consumers)
+    {
+        consumer.join();
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    if (popped.load() != total_operations)
+    {
+        std::cerr << "Lost values: " << total_operations - popped.load() << std::endl;
+    }
+    return static_cast<double>(total_operations) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+int main()
+{
+    std::cout << std::setw(8) << "threads" << std::setw(28) << "ThreadSafeQueue [Mops/s]" << std::setw(35)
+              << "ShardedThreadSafeQueue [Mops/s]" << std::endl;
+
+    for (const int num_threads : THREAD_COUNTS)
+    {
+        common_library::concurrency::ThreadSafeQueue<std::uint64_t> single_queue;
+        const double single = measureThroughput(single_queue, num_threads);
+
+        common_library::concurrency::ShardedThreadSafeQueue<std::uint64_t> sharded_queue;
+        const double sharded = measureThroughput(sharded_queue, num_threads);
+
+        std::cout << std::setw(8) << num_threads << std::setw(28) << single / 1e6 << std::setw(35) << sharded / 1e6
+                  << std::endl;
+    }
+
+    return 0;
+}
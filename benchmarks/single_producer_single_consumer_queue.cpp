@@ -0,0 +1,123 @@
+#include <common_library/concurrency/single_producer_single_consumer_queue.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+constexpr std::size_t QUEUE_SIZE = 1'024;
+constexpr std::uint64_t NUM_OPERATIONS = 10'000'000; // Multiple of BURST_SIZE
+constexpr std::size_t BURST_SIZE = 64;
+constexpr int NUM_RUNS = 5;
+
+// Pushes NUM_OPERATIONS values from one thread and pops them from another, returning the throughput in ops/sec.
+template <bool CacheAligned> double measureThroughput()
+{
+    common_library::concurrency::SingleProducerSingleConsumerQueue<std::uint64_t, CacheAligned> queue(QUEUE_SIZE);
+
+    std::uint64_t checksum = 0;
+
+    std::thread consumer_thread([&queue, &checksum]() {
+        std::uint64_t value;
+        for (std::uint64_t i = 0; i < NUM_OPERATIONS; ++i)
+        {
+            while (!queue.pop(value))
+            {
+                std::this_thread::yield();
+            }
+            checksum += value;
+        }
+    });
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    for (std::uint64_t i = 0; i < NUM_OPERATIONS; ++i)
+    {
+        while (!queue.push(i))
+        {
+            std::this_thread::yield();
+        }
+    }
+    consumer_thread.join();
+
+    const auto t2 = std::chrono::steady_clock::now();
+
+    if (checksum != NUM_OPERATIONS * (NUM_OPERATIONS - 1) / 2)
+    {
+        std::cerr << "Checksum mismatch" << std::endl;
+    }
+
+    return static_cast<double>(NUM_OPERATIONS) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+// Same as measureThroughput, but moves the values in bursts of BURST_SIZE using the bulk API.
+template <bool CacheAligned> double measureBulkThroughput()
+{
+    common_library::concurrency::SingleProducerSingleConsumerQueue<std::uint64_t, CacheAligned> queue(QUEUE_SIZE);
+
+    std::uint64_t checksum = 0;
+
+    std::thread consumer_thread([&queue, &checksum]() {
+        std::uint64_t values[BURST_SIZE];
+        for (std::uint64_t i = 0; i < NUM_OPERATIONS;)
+        {
+            const auto count = queue.pop_up_to(values, BURST_SIZE);
+            if (count == 0U)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                checksum += values[j];
+            }
+            i += count;
+        }
+    });
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    std::uint64_t values[BURST_SIZE];
+    for (std::uint64_t i = 0; i < NUM_OPERATIONS; i += BURST_SIZE)
+    {
+        for (std::size_t j = 0; j < BURST_SIZE; ++j)
+        {
+            values[j] = i + j;
+        }
+        while (!queue.push_bulk(values, BURST_SIZE))
+        {
+            std::this_thread::yield();
+        }
+    }
+    consumer_thread.join();
+
+    const auto t2 = std::chrono::steady_clock::now();
+
+    if (checksum != NUM_OPERATIONS * (NUM_OPERATIONS - 1) / 2)
+    {
+        std::cerr << "Checksum mismatch" << std::endl;
+    }
+
+    return static_cast<double>(NUM_OPERATIONS) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+template <bool CacheAligned, bool Bulk = false> void runBenchmark(const char *name)
+{
+    double best = 0.0;
+    for (int run = 0; run < NUM_RUNS; ++run)
+    {
+        const double ops_per_second =
+            Bulk ? measureBulkThroughput<CacheAligned>() : measureThroughput<CacheAligned>();
+        best = (ops_per_second > best) ? ops_per_second : best;
+    }
+    std::cout << name << ": " << best / 1e6 << " Mops/sec (best of " << NUM_RUNS << " runs)" << std::endl;
+}
+
+int main()
+{
+    runBenchmark<false>("SingleProducerSingleConsumerQueue (default)            ");
+    runBenchmark<true>("SingleProducerSingleConsumerQueue (cache aligned)      ");
+    runBenchmark<true, true>("SingleProducerSingleConsumerQueue (cache aligned, bulk)");
+
+    return 0;
+}
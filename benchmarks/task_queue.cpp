@@ -0,0 +1,142 @@
+#include <common_library/concurrency/bounded_shared_queue.hpp>
+#include <common_library/concurrency/inplace_function.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+using common_library::concurrency::BoundedSharedQueue;
+using common_library::concurrency::BoundedSharedQueueShutdownException;
+using common_library::concurrency::InplaceFunction;
+
+constexpr std::uint64_t NUM_TASKS = 1'000'000;
+constexpr int THREAD_COUNTS[] = {2, 4, 8};
+
+// Counts the calls to the global allocator, to show how many allocations a task costs
+std::atomic<std::uint64_t> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1U, std::memory_order_relaxed);
+    if (void *memory = std::malloc((size != 0U) ? size : 1U))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct Result
+{
+    double throughput;
+    double allocations_per_task;
+};
+
+// Pushes NUM_TASKS tasks, each capturing 32 bytes besides the result counter, from num_threads / 2 producers and runs
+// them on num_threads / 2 consumers
+template <typename Task, bool MOVE> Result measure(int num_threads)
+{
+    const int num_producers = num_threads / 2;
+    const int num_consumers = num_threads - num_producers;
+    const std::uint64_t tasks_per_producer = NUM_TASKS / num_producers;
+
+    BoundedSharedQueue<Task> queue{1024U};
+    std::atomic<std::uint64_t> checksum{0};
+    std::atomic_bool start{false};
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+
+    for (int c = 0; c < num_consumers; ++c)
+    {
+        consumers.emplace_back([&queue]() {
+            try
+            {
+                for (;;)
+                {
+                    queue.pop()();
+                }
+            }
+            catch (const BoundedSharedQueueShutdownException &)
+            {
+            }
+        });
+    }
+    for (int p = 0; p < num_producers; ++p)
+    {
+        producers.emplace_back([&queue, &checksum, &start, tasks_per_producer]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            for (std::uint64_t i = 0; i < tasks_per_producer; ++i)
+            {
+                const std::array<std::uint64_t, 4> payload{i, i + 1U, i + 2U, i + 3U};
+                Task task{[payload, &checksum]() {
+                    checksum.fetch_add(payload[0] + payload[3], std::memory_order_relaxed);
+                }};
+                if constexpr (MOVE)
+                {
+                    queue.push(std::move(task));
+                }
+                else
+                {
+                    queue.push(task);
+                }
+            }
+        });
+    }
+
+    const std::uint64_t allocations_before = allocations.load();
+    const auto t1 = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    queue.close();
+    for (auto &consumer : consumers)
+    {
+        consumer.join();
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    const auto total_tasks = static_cast<double>(tasks_per_producer * num_producers);
+    return Result{total_tasks / std::chrono::duration<double>(t2 - t1).count(),
+                  static_cast<double>(allocations.load() - allocations_before) / total_tasks};
+}
+
+int main()
+{
+    std::cout << std::setw(8) << "threads" << std::setw(36) << "std::function, copied [Mops/s]" << std::setw(14)
+              << "allocs/task" << std::setw(36) << "InplaceFunction, moved [Mops/s]" << std::setw(14) << "allocs/task"
+              << std::endl;
+
+    for (const int num_threads : THREAD_COUNTS)
+    {
+        const Result function = measure<std::function<void()>, false>(num_threads);
+        const Result inplace = measure<InplaceFunction<void()>, true>(num_threads);
+        std::cout << std::setw(8) << num_threads << std::setw(36) << function.throughput / 1e6 << std::setw(14)
+                  << function.allocations_per_task << std::setw(36) << inplace.throughput / 1e6 << std::setw(14)
+                  << inplace.allocations_per_task << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <common_library/concurrency/bounded_shared_queue.hpp>
+#include <common_library/concurrency/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using common_library::concurrency::BoundedSharedQueue;
+using common_library::concurrency::BoundedSharedQueueShutdownException;
+using common_library::concurrency::ThreadPool;
+
+constexpr std::size_t NUM_TASKS = 200'000;
+constexpr std::size_t NUM_INDICES = 4'000'000;
+constexpr std::size_t GRAIN = 64;
+constexpr int SPAWN_DEPTH = 16;
+constexpr int THREAD_COUNTS[] = {1, 2, 4, 8};
+
+// The ad-hoc pool this library used to leave to its users: workers looping over one shared BoundedSharedQueue
+class SharedQueuePool final
+{
+  public:
+    explicit SharedQueuePool(std::size_t thread_count, std::size_t capacity) : queue_(capacity)
+    {
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            threads_.emplace_back([this]() {
+                try
+                {
+                    for (;;)
+                    {
+                        queue_.pop()();
+                    }
+                }
+                catch (const BoundedSharedQueueShutdownException &)
+                {
+                }
+            });
+        }
+    }
+
+    ~SharedQueuePool()
+    {
+        queue_.close();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void submit(std::function<void()> task)
+    {
+        queue_.push(task);
+    }
+
+  private:
+    BoundedSharedQueue<std::function<void()>> queue_;
+    std::vector<std::thread> threads_;
+};
+
+// Stand-in for a small amount of work per task or index
+inline std::uint64_t work(std::uint64_t value) noexcept
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return value;
+}
+
+void waitFor(const std::atomic<std::size_t> &counter, std::size_t expected)
+{
+    while (counter.load(std::memory_order_acquire) != expected)
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename Run> double measure(Run &&run, std::size_t operations)
+{
+    const auto t1 = std::chrono::steady_clock::now();
+    run();
+    const auto t2 = std::chrono::steady_clock::now();
+    return static_cast<double>(operations) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+// NUM_TASKS independent tasks submitted by the main thread
+template <typename Pool> double measureSubmit(Pool &pool)
+{
+    std::atomic<std::size_t> completed{0};
+    std::atomic<std::uint64_t> checksum{0};
+    return measure(
+        [&]() {
+            for (std::size_t i = 0; i < NUM_TASKS; ++i)
+            {
+                pool.submit([i, &completed, &checksum]() {
+                    checksum.fetch_add(work(i), std::memory_order_relaxed);
+                    completed.fetch_add(1U, std::memory_order_release);
+                });
+            }
+            waitFor(completed, NUM_TASKS);
+        },
+        NUM_TASKS);
+}
+
+// NUM_INDICES indices in parts of GRAIN; the shared queue pool gets one task per part
+double measureParallelFor(ThreadPool &pool)
+{
+    std::atomic<std::uint64_t> checksum{0};
+    return measure(
+        [&]() {
+            pool.parallelFor(
+                std::size_t{0}, NUM_INDICES,
+                [&checksum](std::size_t i) {
+                    if (work(i) == 0U)
+                    {
+                        checksum.fetch_add(1U, std::memory_order_relaxed);
+                    }
+                },
+                GRAIN);
+        },
+        NUM_INDICES);
+}
+
+double measureParallelFor(SharedQueuePool &pool)
+{
+    std::atomic<std::size_t> completed{0};
+    std::atomic<std::uint64_t> checksum{0};
+    const std::size_t parts = (NUM_INDICES + GRAIN - 1U) / GRAIN;
+    return measure(
+        [&]() {
+            for (std::size_t first = 0; first < NUM_INDICES; first += GRAIN)
+            {
+                pool.submit([first, &completed, &checksum]() {
+                    const std::size_t last = std::min(first + GRAIN, NUM_INDICES);
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        if (work(i) == 0U)
+                        {
+                            checksum.fetch_add(1U, std::memory_order_relaxed);
+                        }
+                    }
+                    completed.fetch_add(1U, std::memory_order_release);
+                });
+            }
+            waitFor(completed, parts);
+        },
+        NUM_INDICES);
+}
+
+// Binary tree of tasks, each submitting its two children from inside the pool
+template <typename Pool> void spawn(Pool &pool, int depth, std::atomic<std::size_t> &completed)
+{
+    if (depth > 0)
+    {
+        pool.submit([&pool, depth, &completed]() { spawn(pool, depth - 1, completed); });
+        pool.submit([&pool, depth, &completed]() { spawn(pool, depth - 1, completed); });
+    }
+    completed.fetch_add(1U, std::memory_order_release);
+}
+
+template <typename Pool> double measureSpawnTree(Pool &pool)
+{
+    constexpr std::size_t NUM_SPAWNED = (std::size_t{1} << (SPAWN_DEPTH + 1)) - 1U;
+    std::atomic<std::size_t> completed{0};
+    return measure(
+        [&]() {
+            pool.submit([&pool, &completed]() { spawn(pool, SPAWN_DEPTH, completed); });
+            waitFor(completed, NUM_SPAWNED);
+        },
+        NUM_SPAWNED);
+}
+
+int main()
+{
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "workload" << std::setw(30)
+              << "BoundedSharedQueue [Mops/s]" << std::setw(22) << "ThreadPool [Mops/s]" << std::endl;
+
+    for (const int num_threads : THREAD_COUNTS)
+    {
+        const auto thread_count = static_cast<std::size_t>(num_threads);
+        // Large enough for the whole spawn tree: a worker blocked on a full queue could never drain it
+        SharedQueuePool shared_pool{thread_count, std::size_t{1} << (SPAWN_DEPTH + 2)};
+        ThreadPool thread_pool{thread_count};
+
+        const double shared_submit = measureSubmit(shared_pool);
+        const double pool_submit = measureSubmit(thread_pool);
+        std::cout << std::setw(8) << num_threads << std::setw(14) << "submit" << std::setw(30) << shared_submit / 1e6
+                  << std::setw(22) << pool_submit / 1e6 << std::endl;
+
+        const double shared_for = measureParallelFor(shared_pool);
+        const double pool_for = measureParallelFor(thread_pool);
+        std::cout << std::setw(8) << num_threads << std::setw(14) << "parallel for" << std::setw(30)
+                  << shared_for / 1e6 << std::setw(22) << pool_for / 1e6 << std::endl;
+
+        const double shared_spawn = measureSpawnTree(shared_pool);
+        const double pool_spawn = measureSpawnTree(thread_pool);
+        std::cout << std::setw(8) << num_threads << std::setw(14) << "spawn tree" << std::setw(30)
+                  << shared_spawn / 1e6 << std::setw(22) << pool_spawn / 1e6 << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,495 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_BINARY_LOG
+#define COMMON_LIBRARY_CONCURRENCY_BINARY_LOG
+
+#include <common_library/concurrency/cycle_clock.hpp>
+#include <common_library/concurrency/log_record.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace common_library::concurrency
+{
+// Binary log file format, in the byte order of the machine that wrote it:
+//
+//     BinaryLogFileHeader
+//     entries, each starting with a BinaryLogEntryKind byte:
+//         FORMAT   std::uint32_t format id, std::uint16_t argument count, one LogArgumentType byte per argument
+//         MESSAGE  std::uint32_t format id, std::uint64_t CycleClock ticks, std::uint32_t thread id,
+//                  LogLevel byte, std::uint32_t payload size, payload
+//     zero bytes up to the end of the file if the writer did not close the file
+//
+// A format is defined in a file before the first message that uses it. Payloads are serialized as described in
+// LogSerializer, with OPAQUE values already formatted into TEXT by the writer.
+
+// Shifts path.i to path.(i + 1) for the existing files, dropping the oldest one so that at most max_files files
+// remain including path, and moves path to path.1
+inline void rotateLogFiles(const std::string &path, std::size_t max_files)
+{
+    if (max_files <= 1U)
+    {
+        ::unlink(path.c_str());
+        return;
+    }
+
+    for (std::size_t i = max_files - 1U; i > 1U; --i)
+    {
+        ::rename((path + '.' + std::to_string(i - 1U)).c_str(), (path + '.' + std::to_string(i)).c_str());
+    }
+    ::rename(path.c_str(), (path + ".1").c_str());
+}
+
+struct BinaryLogFileHeader
+{
+    static constexpr char MAGIC[8] = {'C', 'L', 'B', 'I', 'N', 'L', 'O', 'G'};
+    static constexpr std::uint32_t VERSION = 2U;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    CycleClock::Calibration calibration;
+};
+
+enum class BinaryLogEntryKind : std::uint8_t
+{
+    END = 0,
+    FORMAT = 1,
+    MESSAGE = 2
+};
+
+// Appends log records to memory-mapped binary log files.
+//
+// The file at path is preallocated to max_file_size bytes and mapped, so writing a message is a copy into memory and
+// messages written before a crash are not lost. When the next message does not fit, the file is truncated to its
+// used size and rotated: path becomes path.1, path.1 becomes path.2, and so on, keeping at most max_files files.
+// An existing file at path is rotated away when the writer is created.
+//
+// Not thread safe: the logger's worker thread is the only user.
+class BinaryLogWriter final
+{
+  public:
+    // Throws std::system_error if the file cannot be created, allocated on disk or mapped
+    BinaryLogWriter(std::string path, std::size_t max_file_size, std::size_t max_files)
+        : path_(std::move(path)), max_file_size_(max_file_size), max_files_(max_files)
+    {
+        if (max_file_size_ <= sizeof(BinaryLogFileHeader))
+        {
+            throw std::invalid_argument("BinaryLogWriter: max_file_size is too small");
+        }
+
+        if (::access(path_.c_str(), F_OK) == 0)
+        {
+            rotateLogFiles(path_, max_files_);
+        }
+        if (!open())
+        {
+            throw std::system_error(errno, std::generic_category(), "BinaryLogWriter: cannot create " + path_);
+        }
+    }
+
+    BinaryLogWriter() = delete;
+    BinaryLogWriter(const BinaryLogWriter &other) = delete;
+    BinaryLogWriter(BinaryLogWriter &&other) noexcept = delete;
+    BinaryLogWriter &operator=(const BinaryLogWriter &other) = delete;
+    BinaryLogWriter &operator=(BinaryLogWriter &&other) noexcept = delete;
+
+    ~BinaryLogWriter()
+    {
+        close();
+    }
+
+    // Appends the record, rotating the file if it is full. Returns false if the message was dropped, because it is
+    // larger than a file or because a new file could not be created.
+    bool write(const LogRecord &record, std::uint32_t thread_id)
+    {
+        if (mapping_ == nullptr)
+        {
+            return false;
+        }
+
+        encodeMessage(record, thread_id);
+
+        auto format = format_ids_.find(record.format);
+        const bool defined = (format != format_ids_.end());
+        if (offset_ + (defined ? 0U : formatEntrySize(*record.format)) + message_.size() > max_file_size_)
+        {
+            close();
+            rotateLogFiles(path_, max_files_);
+            if (!open())
+            {
+                return false;
+            }
+            format = format_ids_.end();
+            if (sizeof(BinaryLogFileHeader) + formatEntrySize(*record.format) + message_.size() > max_file_size_)
+            {
+                return false;
+            }
+        }
+
+        std::uint32_t format_id;
+        if (format == format_ids_.end())
+        {
+            format_id = static_cast<std::uint32_t>(format_ids_.size());
+            format_ids_.emplace(record.format, format_id);
+            appendFormat(*record.format, format_id);
+        }
+        else
+        {
+            format_id = format->second;
+        }
+
+        // The format id is the first field after the entry kind
+        std::memcpy(message_.data() + 1U, &format_id, sizeof(format_id));
+        std::memcpy(mapping_ + offset_, message_.data(), message_.size());
+        offset_ += message_.size();
+        return true;
+    }
+
+  private:
+    std::string path_;
+    std::size_t max_file_size_;
+    std::size_t max_files_;
+
+    int descriptor_{-1};
+    unsigned char *mapping_{nullptr};
+    std::size_t offset_{0U};
+
+    // Formats defined in the current file
+    std::unordered_map<const LogFormat *, std::uint32_t> format_ids_;
+
+    // Scratch space for the message being written and its OPAQUE values
+    std::vector<unsigned char> message_;
+    std::string text_;
+    StringStreamBuffer text_buffer_{text_};
+    std::ostream text_stream_{&text_buffer_};
+
+    // Creates a new file at path_, maps it and writes the header
+    bool open()
+    {
+        descriptor_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (descriptor_ < 0)
+        {
+            return false;
+        }
+
+        // Reserve the blocks rather than only setting the size: stores into a sparse mapping on a full disk raise
+        // SIGBUS, while a failure here is reported to the caller
+        const int error = ::posix_fallocate(descriptor_, 0, static_cast<off_t>(max_file_size_));
+        if (error != 0)
+        {
+            closeDescriptor();
+            errno = error;
+            return false;
+        }
+
+        void *mapping = ::mmap(nullptr, max_file_size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            closeDescriptor();
+            return false;
+        }
+        mapping_ = static_cast<unsigned char *>(mapping);
+
+        BinaryLogFileHeader header{};
+        std::memcpy(header.magic, BinaryLogFileHeader::MAGIC, sizeof(header.magic));
+        header.version = BinaryLogFileHeader::VERSION;
+        header.calibration = CycleClock::calibrate();
+        std::memcpy(mapping_, &header, sizeof(header));
+        offset_ = sizeof(header);
+        format_ids_.clear();
+        return true;
+    }
+
+    // Unmaps the current file and truncates it to its used size
+    void close() noexcept
+    {
+        if (mapping_ == nullptr)
+        {
+            return;
+        }
+
+        ::munmap(mapping_, max_file_size_);
+        mapping_ = nullptr;
+        static_cast<void>(::ftruncate(descriptor_, static_cast<off_t>(offset_)));
+        closeDescriptor();
+    }
+
+    void closeDescriptor() noexcept
+    {
+        ::close(descriptor_);
+        descriptor_ = -1;
+    }
+
+    static std::size_t formatEntrySize(const LogFormat &format) noexcept
+    {
+        return sizeof(BinaryLogEntryKind) + sizeof(std::uint32_t) + sizeof(std::uint16_t) + format.argument_count;
+    }
+
+    void appendFormat(const LogFormat &format, std::uint32_t format_id) noexcept
+    {
+        unsigned char *cursor = mapping_ + offset_;
+        *cursor++ = static_cast<unsigned char>(BinaryLogEntryKind::FORMAT);
+        std::memcpy(cursor, &format_id, sizeof(format_id));
+        cursor += sizeof(format_id);
+        const auto argument_count = static_cast<std::uint16_t>(format.argument_count);
+        std::memcpy(cursor, &argument_count, sizeof(argument_count));
+        cursor += sizeof(argument_count);
+        for (std::size_t i = 0; i < format.argument_count; ++i)
+        {
+            const LogArgumentType type = format.arguments[i].type;
+            *cursor++ = static_cast<unsigned char>((type == LogArgumentType::OPAQUE) ? LogArgumentType::TEXT : type);
+        }
+        offset_ += formatEntrySize(format);
+    }
+
+    template <typename Value> void appendToMessage(const Value &value)
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+        message_.insert(message_.end(), bytes, bytes + sizeof(Value));
+    }
+
+    // Builds the message entry in message_, leaving the format id to be filled in
+    void encodeMessage(const LogRecord &record, std::uint32_t thread_id)
+    {
+        message_.clear();
+        message_.push_back(static_cast<unsigned char>(BinaryLogEntryKind::MESSAGE));
+        appendToMessage(std::uint32_t{0U});
+        appendToMessage(record.timestamp);
+        appendToMessage(thread_id);
+        appendToMessage(record.level);
+        const std::size_t payload_size_offset = message_.size();
+        appendToMessage(std::uint32_t{0U});
+        const std::size_t payload_offset = message_.size();
+
+        const LogFormat &format = *record.format;
+        const unsigned char *cursor = record.payload;
+        for (std::size_t i = 0; i < format.argument_count; ++i)
+        {
+            const LogArgument &argument = format.arguments[i];
+            if (argument.type == LogArgumentType::TEXT)
+            {
+                std::uint32_t length;
+                std::memcpy(&length, cursor, sizeof(length));
+                message_.insert(message_.end(), cursor, cursor + sizeof(length) + length);
+                cursor += sizeof(length) + length;
+            }
+            else if (argument.type == LogArgumentType::OPAQUE)
+            {
+                text_.clear();
+                argument.format(cursor, text_stream_);
+                appendToMessage(static_cast<std::uint32_t>(text_.size()));
+                message_.insert(message_.end(), text_.begin(), text_.end());
+                cursor += argument.size;
+            }
+            else
+            {
+                message_.insert(message_.end(), cursor, cursor + argument.size);
+                cursor += argument.size;
+            }
+        }
+
+        const auto payload_size = static_cast<std::uint32_t>(message_.size() - payload_offset);
+        std::memcpy(message_.data() + payload_size_offset, &payload_size, sizeof(payload_size));
+    }
+};
+
+// Decodes binary log files written by BinaryLogWriter. The file must have been written on a machine with the same
+// byte order and type sizes.
+class BinaryLogReader final
+{
+  public:
+    struct Message
+    {
+        std::int64_t unix_nanoseconds;
+        std::uint32_t thread_id;
+        LogLevel level;
+        std::string text;
+    };
+
+    // Throws std::runtime_error if the file cannot be read or is not a binary log file
+    explicit BinaryLogReader(const std::string &path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+        {
+            throw std::runtime_error("BinaryLogReader: cannot open " + path);
+        }
+        data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        BinaryLogFileHeader header;
+        if (data_.size() < sizeof(header))
+        {
+            throw std::runtime_error("BinaryLogReader: " + path + " is too short");
+        }
+        std::memcpy(&header, data_.data(), sizeof(header));
+        if ((std::memcmp(header.magic, BinaryLogFileHeader::MAGIC, sizeof(header.magic)) != 0) ||
+            (header.version != BinaryLogFileHeader::VERSION))
+        {
+            throw std::runtime_error("BinaryLogReader: " + path + " is not a binary log file");
+        }
+        calibration_ = header.calibration;
+        offset_ = sizeof(header);
+    }
+
+    // Decodes the next message. Returns false at the end of the file. Throws std::runtime_error if the file is
+    // corrupted.
+    bool next(Message &message)
+    {
+        for (;;)
+        {
+            if (offset_ >= data_.size())
+            {
+                return false;
+            }
+
+            const auto kind = static_cast<BinaryLogEntryKind>(read<std::uint8_t>());
+            if (kind == BinaryLogEntryKind::END)
+            {
+                offset_ = data_.size();
+                return false;
+            }
+            if (kind == BinaryLogEntryKind::FORMAT)
+            {
+                readFormat();
+                continue;
+            }
+            if (kind != BinaryLogEntryKind::MESSAGE)
+            {
+                throw std::runtime_error("BinaryLogReader: unknown entry kind");
+            }
+
+            const auto format_id = read<std::uint32_t>();
+            const auto ticks = read<std::uint64_t>();
+            message.thread_id = read<std::uint32_t>();
+            message.level = read<LogLevel>();
+            const auto payload_size = read<std::uint32_t>();
+            message.unix_nanoseconds = CycleClock::toUnixNanoseconds(ticks, calibration_);
+
+            const auto format = formats_.find(format_id);
+            if (format == formats_.end())
+            {
+                throw std::runtime_error("BinaryLogReader: message refers to an undefined format");
+            }
+            const std::size_t payload_end = offset_ + payload_size;
+            check(payload_size);
+
+            std::ostringstream stream;
+            for (const LogArgumentType type : format->second)
+            {
+                readValue(type, stream);
+            }
+            if (offset_ != payload_end)
+            {
+                throw std::runtime_error("BinaryLogReader: payload size does not match its format");
+            }
+            message.text = stream.str();
+            return true;
+        }
+    }
+
+  private:
+    std::vector<char> data_;
+    std::size_t offset_{0U};
+    CycleClock::Calibration calibration_{};
+    std::unordered_map<std::uint32_t, std::vector<LogArgumentType>> formats_;
+
+    void check(std::size_t size) const
+    {
+        if (data_.size() - offset_ < size)
+        {
+            throw std::runtime_error("BinaryLogReader: truncated entry");
+        }
+    }
+
+    template <typename Value> Value read()
+    {
+        check(sizeof(Value));
+        Value value;
+        std::memcpy(&value, data_.data() + offset_, sizeof(Value));
+        offset_ += sizeof(Value);
+        return value;
+    }
+
+    void readFormat()
+    {
+        const auto format_id = read<std::uint32_t>();
+        const auto argument_count = read<std::uint16_t>();
+        std::vector<LogArgumentType> types;
+        types.reserve(argument_count);
+        for (std::uint16_t i = 0; i < argument_count; ++i)
+        {
+            types.push_back(static_cast<LogArgumentType>(read<std::uint8_t>()));
+        }
+        formats_[format_id] = std::move(types);
+    }
+
+    // Prints a value the way operator<< printed it in the logging process
+    void readValue(LogArgumentType type, std::ostream &stream)
+    {
+        switch (type)
+        {
+        case LogArgumentType::TEXT: {
+            const auto length = read<std::uint32_t>();
+            check(length);
+            stream.write(data_.data() + offset_, length);
+            offset_ += length;
+            break;
+        }
+        case LogArgumentType::BOOL:
+            stream << read<bool>();
+            break;
+        case LogArgumentType::CHAR:
+            stream << read<char>();
+            break;
+        case LogArgumentType::INT16:
+            stream << read<std::int16_t>();
+            break;
+        case LogArgumentType::INT32:
+            stream << read<std::int32_t>();
+            break;
+        case LogArgumentType::INT64:
+            stream << read<std::int64_t>();
+            break;
+        case LogArgumentType::UINT16:
+            stream << read<std::uint16_t>();
+            break;
+        case LogArgumentType::UINT32:
+            stream << read<std::uint32_t>();
+            break;
+        case LogArgumentType::UINT64:
+            stream << read<std::uint64_t>();
+            break;
+        case LogArgumentType::FLOAT:
+            stream << read<float>();
+            break;
+        case LogArgumentType::DOUBLE:
+            stream << read<double>();
+            break;
+        case LogArgumentType::LONG_DOUBLE:
+            stream << read<long double>();
+            break;
+        case LogArgumentType::POINTER:
+            stream << read<const void *>();
+            break;
+        default:
+            throw std::runtime_error("BinaryLogReader: unknown argument type");
+        }
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_BINARY_LOG
@@ -1,14 +1,18 @@
 #ifndef COMMON_LIBRARY_CONCURRENCY_BOUNDED_SHARED_QUEUE
 #define COMMON_LIBRARY_CONCURRENCY_BOUNDED_SHARED_QUEUE
 
+#include <common_library/concurrency/multi_producer_multi_consumer_queue.hpp>
+
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <limits>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 namespace common_library::concurrency
@@ -29,19 +33,372 @@ class BoundedSharedQueueShutdownException : public std::runtime_error
     }
 };
 
+// Bounded blocking queue.
+//
+// The items live in a lock-free ring of max_size slots allocated in the constructor, so tryPush/tryPop and the
+// uncontended push/pop never take the mutex. The mutex and the condition variables are used only by threads that have
+// to sleep in push() or pop(): they register in a waiter count, and the other side notifies only while that count is
+// non-zero. The batch operations (popUpTo(), popAll(), pushRange()) notify once per batch rather than once per item.
+//
+// close() stops a queue without losing items: pushes are rejected from then on, while consumers keep taking the
+// remaining items until the queue is empty, after which the blocking pops throw BoundedSharedQueueShutdownException.
+// Destroying the queue instead makes every blocked call throw at once, even if items remain.
 template <typename T> class BoundedSharedQueue
 {
+  public:
+    // The ring of max_size slots, each holding a T and a sequence number, is allocated up front in the constructor, so
+    // max_size costs memory whether or not the queue fills up
+    static constexpr std::size_t DEFAULT_MAX_SIZE = 1024U;
+
   private:
-    std::queue<T> queue_;
+    // Bit of push_state_ set by close()
+    static constexpr std::size_t CLOSED = 1U;
+    // Amount added to push_state_ by every push in progress
+    static constexpr std::size_t PUSH = 2U;
+
+    MultiProducerMultiConsumerQueue<T> queue_;
     std::mutex mutex_;
     std::condition_variable data_available_;
     std::condition_variable space_available_;
+    std::condition_variable drained_;
+    // Threads sleeping in pop(), push() and waitUntilDrained(), respectively. Changed under the mutex only.
+    std::atomic_size_t pop_waiters_{0U};
+    std::atomic_size_t push_waiters_{0U};
+    std::atomic_size_t drain_waiters_{0U};
+    // The CLOSED bit plus PUSH per push in progress. Pushes register before they check the bit, so once the state
+    // equals CLOSED, no more items can arrive.
+    std::atomic_size_t push_state_{0U};
     std::size_t max_size_;
     std::atomic_bool shutdown_;
 
+    enum class WaitResult : std::uint8_t
+    {
+        READY,
+        TIMEOUT,
+        CLOSED,
+        SHUTDOWN
+    };
+
+    [[nodiscard]] static std::size_t checkedMaxSize(std::size_t max_size)
+    {
+        if (max_size == 0U)
+        {
+            throw std::invalid_argument("BoundedSharedQueue: max_size must be positive");
+        }
+        if (max_size > MultiProducerMultiConsumerQueue<T>::MAX_SIZE)
+        {
+            throw std::invalid_argument("BoundedSharedQueue: max_size is too large, the ring is allocated up front");
+        }
+        return max_size;
+    }
+
+    // Whether a pushed item is copied before it goes into the ring. The ring claims a slot before it constructs the
+    // item there, and a slot whose construction threw stays taken until a consumer passes it, without the producers
+    // waiting for space being woken. Moving the copy in cannot throw.
+    template <typename Item>
+    static constexpr bool COPY_FIRST = std::is_lvalue_reference_v<Item> && std::is_nothrow_move_constructible_v<T>;
+
+    // Registers a push in progress. Returns false if the queue is closed.
+    [[nodiscard]] bool beginPush() noexcept
+    {
+        if ((push_state_.fetch_add(PUSH, std::memory_order_acquire) & CLOSED) != 0U)
+        {
+            endPush();
+            return false;
+        }
+        return true;
+    }
+
+    void endPush()
+    {
+        // The last push to end after close() wakes the threads waiting for the queue to run dry
+        if (push_state_.fetch_sub(PUSH, std::memory_order_acq_rel) == (CLOSED + PUSH))
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+            data_available_.notify_all();
+            drained_.notify_all();
+        }
+    }
+
+    // Whether the queue is closed and no push is in progress anymore
+    [[nodiscard]] bool closedForGood() const noexcept
+    {
+        return (push_state_.load(std::memory_order_acquire) == CLOSED);
+    }
+
+    [[nodiscard]] bool drained() const noexcept
+    {
+        const std::size_t state = push_state_.load(std::memory_order_acquire);
+        return (((state & CLOSED) == 0U) || (state == CLOSED)) && queue_.empty();
+    }
+
+    // Wakes threads sleeping on the condition if there are any: one for a single item, all of them for a batch. The
+    // fence pairs with the one in waitUntil(): either the sleeping thread sees the items pushed or popped before the
+    // call, or this call sees the thread's registration.
+    void notifyWaiters(const std::atomic_size_t &waiters, std::condition_variable &condition, std::size_t count)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((count > 0U) && (waiters.load(std::memory_order_relaxed) > 0U))
+        {
+            // A waiter holds the mutex from its registration until it sleeps, so the notification cannot be lost
+            {
+                const std::lock_guard<std::mutex> lock{mutex_};
+            }
+            if (count == 1U)
+            {
+                condition.notify_one();
+            }
+            else
+            {
+                condition.notify_all();
+            }
+        }
+    }
+
+    // Wakes the producers waiting for the space freed by count pops, and the threads in waitUntilDrained() once the
+    // queue is empty
+    void notifyPopped(std::size_t count)
+    {
+        notifyWaiters(push_waiters_, space_available_, count);
+        if ((drain_waiters_.load(std::memory_order_relaxed) > 0U) && queue_.empty())
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+            drained_.notify_all();
+        }
+    }
+
+    // Sleeps on the condition until ready() returns true, the deadline passes or the queue shuts down. Without a
+    // deadline, sleeps until ready() returns true or the queue shuts down.
+    template <typename Ready>
+    [[nodiscard]] WaitResult waitUntil(std::atomic_size_t &waiters, std::condition_variable &condition,
+                                       const std::chrono::steady_clock::time_point *deadline, Ready ready)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        waiters.fetch_add(1U, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const auto done = [this, &ready]() { return shutdown_.load(std::memory_order_relaxed) || ready(); };
+        bool ready_or_shutdown = true;
+        try
+        {
+            if (deadline == nullptr)
+            {
+                condition.wait(lock, done);
+            }
+            else
+            {
+                ready_or_shutdown = condition.wait_until(lock, *deadline, done);
+            }
+        }
+        catch (...)
+        {
+            // ready() may throw from the copy or move of a pushed item
+            waiters.fetch_sub(1U, std::memory_order_relaxed);
+            throw;
+        }
+        waiters.fetch_sub(1U, std::memory_order_relaxed);
+
+        if (shutdown_.load(std::memory_order_relaxed))
+        {
+            return WaitResult::SHUTDOWN;
+        }
+        return ready_or_shutdown ? WaitResult::READY : WaitResult::TIMEOUT;
+    }
+
+    // Takes the oldest item, waiting for one until the deadline if the queue is empty. Throws
+    // BoundedSharedQueueShutdownException if the queue shuts down, or is closed and empty.
+    [[nodiscard]] std::optional<T> popUntil(const std::chrono::steady_clock::time_point *deadline)
+    {
+        if (shutdown_.load(std::memory_order_relaxed))
+        {
+            throw BoundedSharedQueueShutdownException("BoundedSharedQueue shutting down");
+        }
+
+        std::optional<T> item = queue_.tryPop();
+        if (!item.has_value())
+        {
+            const WaitResult result = waitUntil(pop_waiters_, data_available_, deadline, [this, &item]() {
+                if ((item = queue_.tryPop()).has_value())
+                {
+                    return true;
+                }
+                if (!closedForGood())
+                {
+                    return false;
+                }
+                // The last push may have published its item and ended between the two checks
+                item = queue_.tryPop();
+                return true;
+            });
+            if (result == WaitResult::SHUTDOWN)
+            {
+                throw BoundedSharedQueueShutdownException("BoundedSharedQueue shutting down");
+            }
+            if (result == WaitResult::TIMEOUT)
+            {
+                return std::nullopt;
+            }
+            if (!item.has_value())
+            {
+                throw BoundedSharedQueueShutdownException("BoundedSharedQueue is closed and drained");
+            }
+        }
+        return item;
+    }
+
+    // Inserts the item for a registered push, waiting for space until the deadline if the queue is full. The ring
+    // moves an rvalue item only when a slot was claimed, so the attempts may be repeated with the same item.
+    template <typename Item>
+    [[nodiscard]] WaitResult pushRegistered(Item &&item, const std::chrono::steady_clock::time_point *deadline)
+    {
+        if (queue_.tryPush(std::forward<Item>(item)))
+        {
+            return WaitResult::READY;
+        }
+
+        bool pushed = false;
+        const WaitResult result = waitUntil(push_waiters_, space_available_, deadline, [this, &item, &pushed]() {
+            return closed() || (pushed = queue_.tryPush(std::forward<Item>(item)));
+        });
+        return ((result == WaitResult::READY) && !pushed) ? WaitResult::CLOSED : result;
+    }
+
+    static void throwIfStopped(WaitResult result)
+    {
+        if (result == WaitResult::SHUTDOWN)
+        {
+            throw BoundedSharedQueueShutdownException("BoundedSharedQueue is shutting down");
+        }
+        if (result == WaitResult::CLOSED)
+        {
+            throw BoundedSharedQueueShutdownException("BoundedSharedQueue is closed");
+        }
+    }
+
+    // Inserts the item, waiting for space until the deadline if the queue is full. Returns false on timeout. Throws
+    // BoundedSharedQueueShutdownException if the queue shuts down or is closed.
+    template <typename Item>
+    [[nodiscard]] bool pushUntil(Item &&item, const std::chrono::steady_clock::time_point *deadline)
+    {
+        if constexpr (COPY_FIRST<Item>)
+        {
+            return pushUntil(T(item), deadline);
+        }
+        if (shutdown_.load(std::memory_order_relaxed))
+        {
+            throwIfStopped(WaitResult::SHUTDOWN);
+        }
+        if (!beginPush())
+        {
+            throwIfStopped(WaitResult::CLOSED);
+        }
+
+        WaitResult result = WaitResult::READY;
+        try
+        {
+            result = pushRegistered(std::forward<Item>(item), deadline);
+        }
+        catch (...)
+        {
+            endPush();
+            throw;
+        }
+        endPush();
+        throwIfStopped(result);
+        return (result == WaitResult::READY);
+    }
+
+    template <typename Item> [[nodiscard]] bool tryPushItem(Item &&item)
+    {
+        if constexpr (COPY_FIRST<Item>)
+        {
+            return tryPushItem(T(item));
+        }
+        if (shutdown_.load(std::memory_order_relaxed) || !beginPush())
+        {
+            return false;
+        }
+
+        bool pushed = false;
+        try
+        {
+            pushed = queue_.tryPush(std::forward<Item>(item));
+        }
+        catch (...)
+        {
+            endPush();
+            throw;
+        }
+        endPush();
+        if (pushed)
+        {
+            notifyWaiters(pop_waiters_, data_available_, 1U);
+        }
+        return pushed;
+    }
+
+    template <typename Item, typename Rep, typename Period>
+    [[nodiscard]] bool pushItemFor(Item &&item, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        if (!pushUntil(std::forward<Item>(item), &deadline))
+        {
+            return false;
+        }
+        notifyWaiters(pop_waiters_, data_available_, 1U);
+        return true;
+    }
+
+    // Pushes the items for a registered pushRange(). Counts in pushed the items queued since consumers were last woken.
+    template <typename InputIt>
+    [[nodiscard]] WaitResult pushRangeRegistered(InputIt first, InputIt last, std::size_t &pushed)
+    {
+        const auto push_item = [this, &pushed](auto &&item) {
+            using Item = decltype(item);
+            if (queue_.tryPush(std::forward<Item>(item)))
+            {
+                ++pushed;
+                return WaitResult::READY;
+            }
+
+            // Wake the consumers for what is queued before sleeping on the full queue
+            notifyWaiters(pop_waiters_, data_available_, pushed);
+            pushed = 0U;
+            const WaitResult result = pushRegistered(std::forward<Item>(item), nullptr);
+            if (result == WaitResult::READY)
+            {
+                pushed = 1U;
+            }
+            return result;
+        };
+
+        WaitResult result = WaitResult::READY;
+        for (; (first != last) && (result == WaitResult::READY); ++first)
+        {
+            if (shutdown_.load(std::memory_order_relaxed))
+            {
+                result = WaitResult::SHUTDOWN;
+            }
+            else if (closed())
+            {
+                result = WaitResult::CLOSED;
+            }
+            else if constexpr (COPY_FIRST<decltype(*first)>)
+            {
+                result = push_item(T(*first));
+            }
+            else
+            {
+                result = push_item(*first);
+            }
+        }
+        return result;
+    }
+
   public:
-    BoundedSharedQueue(std::size_t max_size = std::numeric_limits<std::size_t>::max())
-        : max_size_(max_size), shutdown_(false)
+    // Throws std::invalid_argument if max_size is zero or too large for the ring to be allocated
+    BoundedSharedQueue(std::size_t max_size = DEFAULT_MAX_SIZE)
+        : queue_(checkedMaxSize(max_size)), max_size_(max_size), shutdown_(false)
     {
     }
 
@@ -57,6 +414,7 @@ template <typename T> class BoundedSharedQueue
         shutdown_.store(true, std::memory_order_release);
         data_available_.notify_all();
         space_available_.notify_all();
+        drained_.notify_all();
     }
 
     [[nodiscard]] bool tryPop(T &item)
@@ -66,73 +424,162 @@ template <typename T> class BoundedSharedQueue
             return false;
         }
 
-        const std::unique_lock<std::mutex> lock{mutex_};
-
-        if (queue_.empty())
+        if (!queue_.tryPop(item))
         {
             return false;
         }
-        else
-        {
-            item = std::move(queue_.front());
-            queue_.pop();
-            space_available_.notify_one();
-            return true;
-        }
+        notifyPopped(1U);
+        return true;
     }
 
+    // Returns false if the queue is full or closed
     [[nodiscard]] bool tryPush(const T &item)
     {
-        if (shutdown_.load(std::memory_order_relaxed))
+        return tryPushItem(item);
+    }
+
+    // Moves the item in. Returns false, leaving the item untouched, if the queue is full or closed.
+    [[nodiscard]] bool tryPush(T &&item)
+    {
+        return tryPushItem(std::move(item));
+    }
+
+    T pop()
+    {
+        std::optional<T> item = popUntil(nullptr);
+        notifyPopped(1U);
+        return std::move(*item);
+    }
+
+    void push(const T &item)
+    {
+        static_cast<void>(pushUntil(item, nullptr));
+        notifyWaiters(pop_waiters_, data_available_, 1U);
+    }
+
+    // Like push(const T &), but moves the item in, which lets the queue hold move-only types such as InplaceFunction.
+    // The item is left untouched if the call throws.
+    void push(T &&item)
+    {
+        static_cast<void>(pushUntil(std::move(item), nullptr));
+        notifyWaiters(pop_waiters_, data_available_, 1U);
+    }
+
+    // Like pop(), but gives up after the timeout. Returns false if no item arrived in time.
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool popFor(T &item, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::optional<T> popped = popUntil(&deadline);
+        if (!popped.has_value())
         {
             return false;
         }
+        item = std::move(*popped);
+        notifyPopped(1U);
+        return true;
+    }
+
+    // Like push(), but gives up after the timeout. Returns false if no space became free in time.
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool pushFor(const T &item, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return pushItemFor(item, timeout);
+    }
 
-        const std::unique_lock<std::mutex> lock{mutex_};
+    // Like pushFor(const T &, timeout), but moves the item in. The item is left untouched on timeout.
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool pushFor(T &&item, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return pushItemFor(std::move(item), timeout);
+    }
 
-        if ((queue_.size() < max_size_))
+    // Waits like pop() for the first item, then moves it and up to max_count - 1 further items that are already queued
+    // to the output iterator, oldest first. Returns the number of items moved. Throws
+    // BoundedSharedQueueShutdownException if the queue shuts down, or is closed and empty.
+    template <typename OutputIt> std::size_t popUpTo(std::size_t max_count, OutputIt output)
+    {
+        if (max_count == 0U)
         {
-            queue_.push(item);
-            data_available_.notify_one();
-            return true;
+            return 0U;
         }
-        else
+
+        std::optional<T> item = popUntil(nullptr);
+        std::size_t count = 0U;
+        do
         {
-            return false;
-        }
+            *output = std::move(*item);
+            ++output;
+            ++count;
+        } while ((count < max_count) && (item = queue_.tryPop()).has_value());
+
+        notifyPopped(count);
+        return count;
     }
 
-    T pop()
+    // Waits like pop() for the first item, then moves it and every item already queued to the output iterator
+    template <typename OutputIt> std::size_t popAll(OutputIt output)
     {
-        std::unique_lock<std::mutex> lock{mutex_};
-
-        data_available_.wait(lock, [this]() { return !queue_.empty() || shutdown_.load(std::memory_order_relaxed); });
+        return popUpTo(std::numeric_limits<std::size_t>::max(), output);
+    }
 
+    // Pushes the items in order, waiting for space like push() whenever the queue is full. Consumers are woken once
+    // per run of items that fit without waiting. Throws BoundedSharedQueueShutdownException if the queue shuts down or
+    // is closed; the items before the one that could not be pushed stay in the queue. With move iterators, the items
+    // are moved in.
+    template <typename InputIt> void pushRange(InputIt first, InputIt last)
+    {
         if (shutdown_.load(std::memory_order_relaxed))
         {
-            throw BoundedSharedQueueShutdownException("BoundedSharedQueue shutting down");
+            throwIfStopped(WaitResult::SHUTDOWN);
+        }
+        if (!beginPush())
+        {
+            throwIfStopped(WaitResult::CLOSED);
         }
 
-        auto item = std::move(queue_.front());
-        queue_.pop();
-        space_available_.notify_one();
-        return item;
+        WaitResult result = WaitResult::READY;
+        std::size_t pushed = 0U;
+        try
+        {
+            result = pushRangeRegistered(first, last, pushed);
+        }
+        catch (...)
+        {
+            endPush();
+            notifyWaiters(pop_waiters_, data_available_, pushed);
+            throw;
+        }
+        endPush();
+        notifyWaiters(pop_waiters_, data_available_, pushed);
+        throwIfStopped(result);
     }
 
-    void push(const T &item)
+    // Rejects every push from now on, while the items already queued can still be popped. Once the queue is empty, the
+    // blocking pops throw BoundedSharedQueueShutdownException instead of waiting.
+    void close()
     {
-        std::unique_lock<std::mutex> lock{mutex_};
+        const std::lock_guard<std::mutex> lock{mutex_};
 
-        space_available_.wait(
-            lock, [this]() { return (queue_.size() < max_size_) || shutdown_.load(std::memory_order_relaxed); });
+        push_state_.fetch_or(CLOSED, std::memory_order_acq_rel);
+        data_available_.notify_all();
+        space_available_.notify_all();
+        drained_.notify_all();
+    }
 
-        if (shutdown_.load(std::memory_order_relaxed))
+    [[nodiscard]] bool closed() const noexcept
+    {
+        return ((push_state_.load(std::memory_order_acquire) & CLOSED) != 0U);
+    }
+
+    // Blocks until the queue is empty. After close(), this means that the consumers have taken every item, including
+    // those of pushes that were in progress when the queue was closed. Returns early if the queue shuts down.
+    void waitUntilDrained()
+    {
+        if (!drained())
         {
-            throw BoundedSharedQueueShutdownException("BoundedSharedQueue is shutting down");
+            static_cast<void>(waitUntil(drain_waiters_, drained_, nullptr, [this]() { return drained(); }));
         }
-
-        queue_.push(item);
-        data_available_.notify_one();
     }
 
     [[nodiscard]] std::size_t maxSize() const noexcept
@@ -140,24 +587,20 @@ template <typename T> class BoundedSharedQueue
         return max_size_;
     }
 
-    [[nodiscard]] bool empty() const
-    {
-        const std::lock_guard<std::mutex> lock{mutex_};
+    // The observers below are exact only when no other thread is pushing or popping at the same time.
 
+    [[nodiscard]] bool empty() const noexcept
+    {
         return queue_.empty();
     }
 
-    [[nodiscard]] bool full() const
+    [[nodiscard]] bool full() const noexcept
     {
-        const std::lock_guard<std::mutex> lock{mutex_};
-
-        return (queue_.size() == max_size_);
+        return queue_.full();
     }
 
-    [[nodiscard]] std::size_t size() const
+    [[nodiscard]] std::size_t size() const noexcept
     {
-        const std::lock_guard<std::mutex> lock{mutex_};
-
         return queue_.size();
     }
 };
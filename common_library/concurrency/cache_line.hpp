@@ -0,0 +1,25 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_CACHE_LINE
+#define COMMON_LIBRARY_CONCURRENCY_CACHE_LINE
+
+#include <cstdint>
+
+namespace common_library::concurrency
+{
+// Size of the cache line assumed when separating data written by different threads.
+// std::hardware_destructive_interference_size is not used, because its value may differ between translation units
+// compiled with different tuning flags, which would make the layout of the containers ABI-unstable.
+inline constexpr std::size_t CACHE_LINE_SIZE = 64U;
+
+// Rounds the value up to the nearest power of two. Zero is rounded up to one.
+[[nodiscard]] constexpr std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+{
+    std::size_t result = 1U;
+    while (result < value)
+    {
+        result <<= 1U;
+    }
+    return result;
+}
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_CACHE_LINE
@@ -0,0 +1,82 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_CYCLE_CLOCK
+#define COMMON_LIBRARY_CONCURRENCY_CYCLE_CLOCK
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace common_library::concurrency
+{
+// Cheap timestamp source for hot paths.
+//
+// On x86 it reads the time stamp counter, which costs a few nanoseconds and runs at a constant rate on current
+// processors; elsewhere a tick is a nanosecond of the steady clock. Ticks are converted to wall-clock time with a
+// Calibration taken by the process that recorded them.
+class CycleClock final
+{
+  public:
+    // Tick rate and a tick count paired with the system time at the same instant
+    struct Calibration
+    {
+        double ticks_per_second;
+        std::uint64_t reference_ticks;
+        std::int64_t reference_unix_nanoseconds;
+    };
+
+    CycleClock() = delete;
+
+    [[nodiscard]] static std::uint64_t now() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+#endif
+    }
+
+    // Returns a calibration for the current instant. The tick rate is measured on the first call, which blocks for
+    // CALIBRATION_PERIOD on x86.
+    [[nodiscard]] static Calibration calibrate()
+    {
+        static const double ticks_per_second = measureTicksPerSecond();
+        const std::int64_t unix_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                  std::chrono::system_clock::now().time_since_epoch())
+                                                  .count();
+        return Calibration{ticks_per_second, now(), unix_nanoseconds};
+    }
+
+    // Converts a tick count to nanoseconds since the Unix epoch
+    [[nodiscard]] static std::int64_t toUnixNanoseconds(std::uint64_t ticks, const Calibration &calibration) noexcept
+    {
+        const auto elapsed_ticks = static_cast<std::int64_t>(ticks - calibration.reference_ticks);
+        const double elapsed_nanoseconds = static_cast<double>(elapsed_ticks) * 1e9 / calibration.ticks_per_second;
+        return calibration.reference_unix_nanoseconds + static_cast<std::int64_t>(elapsed_nanoseconds);
+    }
+
+  private:
+    static constexpr std::chrono::milliseconds CALIBRATION_PERIOD{20};
+
+    static double measureTicksPerSecond()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto start_time = std::chrono::steady_clock::now();
+        const std::uint64_t start_ticks = now();
+        std::this_thread::sleep_for(CALIBRATION_PERIOD);
+        const std::uint64_t end_ticks = now();
+        const auto end_time = std::chrono::steady_clock::now();
+        return static_cast<double>(end_ticks - start_ticks) /
+               std::chrono::duration<double>(end_time - start_time).count();
+#else
+        return 1e9;
+#endif
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_CYCLE_CLOCK
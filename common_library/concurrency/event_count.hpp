@@ -0,0 +1,189 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_EVENT_COUNT
+#define COMMON_LIBRARY_CONCURRENCY_EVENT_COUNT
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace common_library::concurrency
+{
+// Hint to the processor that the calling thread is busy-waiting
+inline void cpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Event count: lets threads sleep until a condition on a lock-free data structure may have changed, without taking
+// a lock on the fast path. Notifying is a fence and a load when nobody waits.
+//
+// Waiting protocol:
+//     while (!condition())
+//     {
+//         const auto key = event_count.prepareWait();
+//         if (condition())
+//         {
+//             event_count.cancelWait();
+//             break;
+//         }
+//         event_count.wait(key);
+//     }
+//
+// Notifying protocol: make the condition true, then call notifyOne() or notifyAll().
+//
+// Sleeping threads are parked on a futex on Linux and on a condition variable elsewhere.
+class EventCount final
+{
+  public:
+    using Key = std::uint32_t;
+
+    EventCount() = default;
+    EventCount(const EventCount &other) = delete;
+    EventCount(EventCount &&other) noexcept = delete;
+    EventCount &operator=(const EventCount &other) = delete;
+    EventCount &operator=(EventCount &&other) noexcept = delete;
+
+    // Registers the calling thread as a waiter. The condition must be re-checked after this call and before wait().
+    [[nodiscard]] Key prepareWait() noexcept
+    {
+        waiters_.fetch_add(1U, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    // Unregisters the calling thread if the condition became true after prepareWait()
+    void cancelWait() noexcept
+    {
+        waiters_.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    // Blocks until a notification issued after prepareWait() returned the key
+    void wait(Key key) noexcept
+    {
+        while (epoch_.load(std::memory_order_acquire) == key)
+        {
+            park(key);
+        }
+        waiters_.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    // Blocks until a notification issued after prepareWait() returned the key, or until the deadline.
+    // Returns false if the deadline passed without a notification.
+    bool waitUntil(Key key, std::chrono::steady_clock::time_point deadline) noexcept
+    {
+        bool notified = true;
+        while (epoch_.load(std::memory_order_acquire) == key)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                notified = false;
+                break;
+            }
+            parkFor(key, std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+        }
+        waiters_.fetch_sub(1U, std::memory_order_relaxed);
+        return notified;
+    }
+
+    // Wakes one waiting thread, if any
+    void notifyOne() noexcept
+    {
+        notify(1);
+    }
+
+    // Wakes all waiting threads, if any
+    void notifyAll() noexcept
+    {
+        notify(INT_MAX);
+    }
+
+  private:
+    std::atomic<Key> epoch_{0U};
+    std::atomic<std::uint32_t> waiters_{0U};
+#if !defined(__linux__)
+    std::mutex mutex_;
+    std::condition_variable condition_;
+#endif
+
+    void notify(int count) noexcept
+    {
+        // Orders the caller's update of the condition before the check for waiters, pairing with the fence in
+        // prepareWait(): either the waiter sees the condition or the notifier sees the waiter.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0U)
+        {
+            return;
+        }
+
+        epoch_.fetch_add(1U, std::memory_order_release);
+        unpark(count);
+    }
+
+#if defined(__linux__)
+    void park(Key key) noexcept
+    {
+        static_assert(sizeof(std::atomic<Key>) == sizeof(Key), "futex requires a plain 32-bit word");
+        syscall(SYS_futex, reinterpret_cast<Key *>(&epoch_), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+    }
+
+    void parkFor(Key key, std::chrono::nanoseconds timeout) noexcept
+    {
+        constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+        timespec relative_timeout{};
+        relative_timeout.tv_sec = static_cast<std::time_t>(timeout.count() / NANOSECONDS_PER_SECOND);
+        relative_timeout.tv_nsec = static_cast<long>(timeout.count() % NANOSECONDS_PER_SECOND);
+        syscall(SYS_futex, reinterpret_cast<Key *>(&epoch_), FUTEX_WAIT_PRIVATE, key, &relative_timeout, nullptr, 0);
+    }
+
+    void unpark(int count) noexcept
+    {
+        syscall(SYS_futex, reinterpret_cast<Key *>(&epoch_), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+#else
+    void park(Key key)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        condition_.wait(lock, [this, key]() { return epoch_.load(std::memory_order_acquire) != key; });
+    }
+
+    void parkFor(Key key, std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        condition_.wait_for(lock, timeout, [this, key]() { return epoch_.load(std::memory_order_acquire) != key; });
+    }
+
+    void unpark(int count)
+    {
+        // Taking the mutex closes the window between a waiter's check of the epoch and its sleep
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+        }
+        if (count == 1)
+        {
+            condition_.notify_one();
+        }
+        else
+        {
+            condition_.notify_all();
+        }
+    }
+#endif
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_EVENT_COUNT
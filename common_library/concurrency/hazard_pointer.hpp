@@ -0,0 +1,295 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_HAZARD_POINTER
+#define COMMON_LIBRARY_CONCURRENCY_HAZARD_POINTER
+
+#include <common_library/concurrency/cache_line.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace common_library::concurrency
+{
+// Hazard pointer based safe memory reclamation for lock-free data structures.
+//
+// A thread that is about to dereference a shared node publishes the node's address in a HazardPointer. A thread that
+// unlinks a node hands it to HazardPointerDomain::retire() instead of deleting it; retired nodes are kept on a
+// thread-local list and deleted in batches, skipping every node that is still published by some HazardPointer.
+//
+// Usage:
+//     HazardPointer hazard_pointer;
+//     Node *node = hazard_pointer.protect(shared_head); // node cannot be deleted until the hazard pointer is reset
+//     ...
+//     hazard_pointer.reset();
+//     HazardPointerDomain::instance().retire(unlinked_node);
+class HazardPointerDomain final
+{
+  public:
+    // Slot holding one published pointer. Records are allocated once and reused for the lifetime of the domain.
+    struct alignas(CACHE_LINE_SIZE) Record
+    {
+        std::atomic<const void *> pointer{nullptr};
+        std::atomic_bool active{false};
+        Record *next{nullptr};
+    };
+
+    // Global domain shared by all lock-free containers of the library
+    static HazardPointerDomain &instance()
+    {
+        static HazardPointerDomain domain;
+        return domain;
+    }
+
+    HazardPointerDomain(const HazardPointerDomain &other) = delete;
+    HazardPointerDomain(HazardPointerDomain &&other) noexcept = delete;
+    HazardPointerDomain &operator=(const HazardPointerDomain &other) = delete;
+    HazardPointerDomain &operator=(HazardPointerDomain &&other) noexcept = delete;
+
+    ~HazardPointerDomain()
+    {
+        for (const auto &retired : orphans_)
+        {
+            retired.deleter(retired.pointer);
+        }
+
+        Record *record = records_.load(std::memory_order_acquire);
+        while (record != nullptr)
+        {
+            delete std::exchange(record, record->next);
+        }
+    }
+
+    // Defers deletion of the pointer until no hazard pointer publishes it
+    template <typename T> void retire(T *pointer)
+    {
+        retire(pointer, [](void *p) { delete static_cast<T *>(p); });
+    }
+
+    // Defers the call of the deleter on the pointer until no hazard pointer publishes it
+    void retire(void *pointer, void (*deleter)(void *))
+    {
+        auto &retired_list = threadRetiredList();
+        retired_list.retired.push_back(Retired{pointer, deleter});
+
+        // Amortize the cost of a scan over a number of retired pointers proportional to the number of records,
+        // so that every scan frees at least half of the list.
+        const std::size_t threshold =
+            std::max(RETIRED_LIST_MIN_SCAN_THRESHOLD, 2U * record_count_.load(std::memory_order_relaxed));
+        if (retired_list.retired.size() >= threshold)
+        {
+            scan(retired_list);
+        }
+    }
+
+    // Deletes the pointers retired by the calling thread that are no longer published
+    void reclaim()
+    {
+        scan(threadRetiredList());
+    }
+
+    // Returns a record to be used by the calling thread, reusing the ones released by this thread first
+    [[nodiscard]] Record *acquireRecord()
+    {
+        auto &record_cache = threadRecordCache();
+        if (record_cache.count > 0U)
+        {
+            return record_cache.records[--record_cache.count];
+        }
+
+        for (Record *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            bool expected = false;
+            if (!record->active.load(std::memory_order_relaxed) &&
+                record->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return record;
+            }
+        }
+
+        auto *record = new Record{};
+        record->active.store(true, std::memory_order_relaxed);
+        record->next = records_.load(std::memory_order_relaxed);
+        while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                               std::memory_order_relaxed))
+        {
+        }
+        record_count_.fetch_add(1U, std::memory_order_relaxed);
+        return record;
+    }
+
+    // Clears the record and keeps it in the calling thread's cache for the next acquireRecord()
+    void releaseRecord(Record *record) noexcept
+    {
+        record->pointer.store(nullptr, std::memory_order_release);
+
+        auto &record_cache = threadRecordCache();
+        if (record_cache.count < RECORD_CACHE_SIZE)
+        {
+            record_cache.records[record_cache.count++] = record;
+        }
+        else
+        {
+            record->active.store(false, std::memory_order_release);
+        }
+    }
+
+  private:
+    static constexpr std::size_t RECORD_CACHE_SIZE = 8U;
+    static constexpr std::size_t RETIRED_LIST_MIN_SCAN_THRESHOLD = 64U;
+
+    struct Retired
+    {
+        void *pointer;
+        void (*deleter)(void *);
+    };
+
+    // Records released by a thread, kept active so that the thread can reacquire them without scanning the list
+    struct RecordCache
+    {
+        Record *records[RECORD_CACHE_SIZE];
+        std::size_t count{0U};
+
+        ~RecordCache()
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                records[i]->active.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    // Pointers retired by a thread. Whatever is still published when the thread exits is handed over to the domain.
+    struct RetiredList
+    {
+        std::vector<Retired> retired;
+        // Published pointers collected by scan(), kept so that scans reuse its capacity instead of allocating
+        std::vector<const void *> hazards;
+
+        ~RetiredList()
+        {
+            auto &domain = HazardPointerDomain::instance();
+            domain.scan(*this);
+            if (!retired.empty())
+            {
+                const std::lock_guard<std::mutex> lock{domain.orphans_mutex_};
+                domain.orphans_.insert(domain.orphans_.end(), retired.begin(), retired.end());
+            }
+        }
+    };
+
+    std::atomic<Record *> records_{nullptr};
+    std::atomic_size_t record_count_{0U};
+    std::mutex orphans_mutex_;
+    std::vector<Retired> orphans_;
+
+    HazardPointerDomain() = default;
+
+    static RecordCache &threadRecordCache() noexcept
+    {
+        static thread_local RecordCache record_cache;
+        return record_cache;
+    }
+
+    static RetiredList &threadRetiredList() noexcept
+    {
+        static thread_local RetiredList retired_list;
+        return retired_list;
+    }
+
+    // Deletes every retired pointer that is not published by any record, keeping the rest in the list.
+    // Pointers orphaned by exited threads are adopted by the list first.
+    void scan(RetiredList &retired_list)
+    {
+        std::vector<Retired> &retired = retired_list.retired;
+        {
+            const std::unique_lock<std::mutex> lock{orphans_mutex_, std::try_to_lock};
+            if (lock.owns_lock() && !orphans_.empty())
+            {
+                retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+                orphans_.clear();
+            }
+        }
+
+        // Pairs with the sequentially consistent publication in HazardPointer::reset(): a pointer published before it
+        // was unlinked is seen here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Allocates only when records were added since the last scan of this thread
+        std::vector<const void *> &hazards = retired_list.hazards;
+        hazards.clear();
+        hazards.reserve(record_count_.load(std::memory_order_relaxed));
+        for (Record *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            if (const void *pointer = record->pointer.load(std::memory_order_acquire))
+            {
+                hazards.push_back(pointer);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        const auto still_hazardous = std::partition(retired.begin(), retired.end(), [&hazards](const Retired &r) {
+            return std::binary_search(hazards.begin(), hazards.end(), static_cast<const void *>(r.pointer));
+        });
+        for (auto it = still_hazardous; it != retired.end(); ++it)
+        {
+            it->deleter(it->pointer);
+        }
+        retired.erase(still_hazardous, retired.end());
+    }
+};
+
+// Owner of a single hazard pointer slot of the global HazardPointerDomain
+class HazardPointer final
+{
+  public:
+    HazardPointer() : record_(HazardPointerDomain::instance().acquireRecord())
+    {
+    }
+
+    ~HazardPointer()
+    {
+        HazardPointerDomain::instance().releaseRecord(record_);
+    }
+
+    HazardPointer(const HazardPointer &other) = delete;
+    HazardPointer(HazardPointer &&other) noexcept = delete;
+    HazardPointer &operator=(const HazardPointer &other) = delete;
+    HazardPointer &operator=(HazardPointer &&other) noexcept = delete;
+
+    // Loads the pointer from the source and publishes it, retrying until the published value is still current.
+    // The returned pointer stays valid until reset() or destruction, even if it is unlinked and retired meanwhile.
+    template <typename T> [[nodiscard]] T *protect(const std::atomic<T *> &source) noexcept
+    {
+        T *pointer = source.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            reset(pointer);
+            T *current = source.load(std::memory_order_seq_cst);
+            if (current == pointer)
+            {
+                return pointer;
+            }
+            pointer = current;
+        }
+    }
+
+    // Publishes the pointer. The caller has to validate that the pointee was not retired before it was published.
+    template <typename T> void reset(T *pointer) noexcept
+    {
+        record_->pointer.store(pointer, std::memory_order_seq_cst);
+    }
+
+    // Clears the published pointer
+    void reset() noexcept
+    {
+        record_->pointer.store(nullptr, std::memory_order_release);
+    }
+
+  private:
+    HazardPointerDomain::Record *record_;
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_HAZARD_POINTER
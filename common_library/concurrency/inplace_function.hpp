@@ -0,0 +1,154 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_INPLACE_FUNCTION
+#define COMMON_LIBRARY_CONCURRENCY_INPLACE_FUNCTION
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace common_library::concurrency
+{
+template <typename Signature, std::size_t Capacity = 48U, std::size_t Alignment = alignof(std::max_align_t)>
+class InplaceFunction;
+
+// Move-only replacement for std::function that stores the callable in a buffer of Capacity bytes inside the object
+// and never allocates. A callable that does not fit, or needs a stricter alignment, is rejected at compile time
+// rather than moved to the heap; raise Capacity for it.
+//
+// With the default capacity, an InplaceFunction takes 64 bytes on 64-bit targets, so that a queue of tasks moves
+// one cache line per task. The callable must be nothrow move constructible, which keeps moving an InplaceFunction
+// in and out of queues noexcept.
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment>
+class InplaceFunction<R(Args...), Capacity, Alignment> final
+{
+  private:
+    // Operations on the stored callable, one table per callable type
+    struct Operations
+    {
+        R (*invoke)(void *callable, Args &&...args);
+        // Move constructs the callable into destination and destroys the source
+        void (*relocate)(void *source, void *destination) noexcept;
+        void (*destroy)(void *callable) noexcept;
+    };
+
+    template <typename Callable> struct OperationsOf
+    {
+        static R invoke(void *callable, Args &&...args)
+        {
+            return std::invoke(*static_cast<Callable *>(callable), std::forward<Args>(args)...);
+        }
+
+        static void relocate(void *source, void *destination) noexcept
+        {
+            auto *callable = static_cast<Callable *>(source);
+            ::new (destination) Callable(std::move(*callable));
+            callable->~Callable();
+        }
+
+        static void destroy(void *callable) noexcept
+        {
+            static_cast<Callable *>(callable)->~Callable();
+        }
+
+        static constexpr Operations OPERATIONS{&invoke, &relocate, &destroy};
+    };
+
+    alignas(Alignment) unsigned char storage_[Capacity];
+    // nullptr when empty
+    const Operations *operations_{nullptr};
+
+    template <typename Function>
+    static constexpr bool IS_CALLABLE = !std::is_same_v<std::decay_t<Function>, InplaceFunction> &&
+                                        !std::is_same_v<std::decay_t<Function>, std::nullptr_t> &&
+                                        std::is_invocable_r_v<R, std::decay_t<Function> &, Args...>;
+
+    void reset() noexcept
+    {
+        if (operations_ != nullptr)
+        {
+            operations_->destroy(storage_);
+            operations_ = nullptr;
+        }
+    }
+
+  public:
+    static constexpr std::size_t CAPACITY = Capacity;
+    static constexpr std::size_t ALIGNMENT = Alignment;
+
+    InplaceFunction() noexcept = default;
+
+    InplaceFunction(std::nullptr_t) noexcept
+    {
+    }
+
+    template <typename Function, typename = std::enable_if_t<IS_CALLABLE<Function>>>
+    InplaceFunction(Function &&function) noexcept(std::is_nothrow_constructible_v<std::decay_t<Function>, Function>)
+    {
+        using Callable = std::decay_t<Function>;
+        static_assert(sizeof(Callable) <= Capacity,
+                      "InplaceFunction: the callable does not fit into the inline storage, increase Capacity");
+        static_assert(Alignment % alignof(Callable) == 0U,
+                      "InplaceFunction: the callable needs a stricter alignment, increase Alignment");
+        static_assert(std::is_nothrow_move_constructible_v<Callable>,
+                      "InplaceFunction: the callable must be nothrow move constructible");
+
+        ::new (static_cast<void *>(storage_)) Callable(std::forward<Function>(function));
+        operations_ = &OperationsOf<Callable>::OPERATIONS;
+    }
+
+    InplaceFunction(const InplaceFunction &other) = delete;
+    InplaceFunction &operator=(const InplaceFunction &other) = delete;
+
+    InplaceFunction(InplaceFunction &&other) noexcept : operations_(other.operations_)
+    {
+        if (operations_ != nullptr)
+        {
+            operations_->relocate(other.storage_, storage_);
+            other.operations_ = nullptr;
+        }
+    }
+
+    InplaceFunction &operator=(InplaceFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.operations_ != nullptr)
+            {
+                other.operations_->relocate(other.storage_, storage_);
+                operations_ = std::exchange(other.operations_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return (operations_ != nullptr);
+    }
+
+    // Calls the stored callable. Throws std::bad_function_call if there is none.
+    R operator()(Args... args)
+    {
+        if (operations_ == nullptr)
+        {
+            throw std::bad_function_call();
+        }
+        return operations_->invoke(storage_, std::forward<Args>(args)...);
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_INPLACE_FUNCTION
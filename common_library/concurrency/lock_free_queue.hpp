@@ -1,8 +1,17 @@
 #ifndef COMMON_LIBRARY_CONCURRENCY_LOCK_FREE_QUEUE
 #define COMMON_LIBRARY_CONCURRENCY_LOCK_FREE_QUEUE
 
+#include <common_library/concurrency/event_count.hpp>
+#include <common_library/concurrency/hazard_pointer.hpp>
+#include <common_library/concurrency/node_pool.hpp>
+
 #include <atomic>
 #include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace common_library::concurrency
 {
@@ -10,18 +19,18 @@ template <typename T> class LockFreeQueue
 {
   private:
     // The Node structure holds the data and a pointer to the next Node in the queue.
-    // Both are stored in an atomic to ensure thread-safety during modification and access.
+    // The data lives in raw storage: it is constructed when the Node is pushed and moved out and destroyed when the
+    // Node is popped, so the dummy Node at the head never holds a value and T needs no default constructor.
     struct Node
     {
-        explicit Node(const T &data) : data{data}, next{nullptr}
-        {
-        }
+        Node() = default;
 
-        Node() : data{}, next{nullptr}
+        [[nodiscard]] T *data() noexcept
         {
+            return std::launder(reinterpret_cast<T *>(storage));
         }
 
-        T data;
+        alignas(T) unsigned char storage[sizeof(T)];
         std::atomic<Node *> next{nullptr};
     };
 
@@ -30,6 +39,46 @@ template <typename T> class LockFreeQueue
     std::atomic<Node *> head_{nullptr};
     std::atomic<Node *> tail_{nullptr};
 
+    // Consumers blocked in wait_pop() sleep on it. Producers only pay for a notification when somebody sleeps.
+    EventCount not_empty_;
+
+    // Number of busy-wait and yield rounds wait_pop() goes through before putting the thread to sleep
+    static constexpr int WAIT_POP_SPIN_ITERATIONS = 128;
+    static constexpr int WAIT_POP_YIELD_ITERATIONS = 16;
+
+    // Nodes are recycled through a pool shared by all queues of the same type, so that push and pop do not reach the
+    // global allocator once the pool has grown to the working set of the program.
+    using NodeAllocator = NodePool<Node>;
+
+    // Creates a Node without data
+    static Node *createDummyNode()
+    {
+        return ::new (NodeAllocator::allocate()) Node{};
+    }
+
+    // Creates a Node holding data constructed from the arguments
+    template <typename... Args> static Node *createNode(Args &&...args)
+    {
+        Node *node = createDummyNode();
+        try
+        {
+            ::new (static_cast<void *>(node->storage)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            destroyNode(node);
+            throw;
+        }
+        return node;
+    }
+
+    // Releases a Node. Its data, if any, must have been destroyed already.
+    static void destroyNode(void *node) noexcept
+    {
+        static_cast<Node *>(node)->~Node();
+        NodeAllocator::deallocate(node);
+    }
+
   public:
     // The queue can't be copied or moved to prevent potential threading issues.
     LockFreeQueue(const LockFreeQueue &other) = delete;
@@ -40,87 +89,220 @@ template <typename T> class LockFreeQueue
     // The constructor initializes an empty Node and sets both the head and tail to point to it.
     LockFreeQueue()
     {
-        Node *new_node = new Node{};
+        Node *new_node = createDummyNode();
 
-        head_.store(new_node, std::memory_order_acquire);
-        tail_.store(new_node, std::memory_order_acquire);
+        head_.store(new_node, std::memory_order_relaxed);
+        tail_.store(new_node, std::memory_order_release);
     }
 
-    // Destructor deletes all Nodes in the queue.
+    // Destructor deletes all Nodes in the queue and the data of every Node after the dummy head.
+    // Nodes popped earlier are owned by the HazardPointerDomain and deleted once no thread protects them.
     ~LockFreeQueue()
     {
-        while (Node *old_head = head_.load(std::memory_order_acquire))
+        Node *node = head_.load(std::memory_order_acquire);
+        Node *next = node->next.load(std::memory_order_acquire);
+        destroyNode(node);
+
+        while (next != nullptr)
         {
-            head_.store(old_head->next, std::memory_order_release);
-            delete old_head;
+            node = next;
+            next = node->next.load(std::memory_order_acquire);
+            std::destroy_at(node->data());
+            destroyNode(node);
         }
     }
 
-    // Takes an element from the queue
+    // Takes an element from the queue.
+    // Allocates the returned pointer; try_pop() moves the element out without allocating.
     std::unique_ptr<T> pop()
     {
-        // Save current head to old head.
-        Node *old_head = head_.load(std::memory_order_acquire);
+        std::optional<T> value = try_pop();
+        if (!value)
+        {
+            return nullptr;
+        }
+        return std::make_unique<T>(std::move(*value));
+    }
+
+    // Takes an element from the queue, or returns an empty optional if the queue is empty
+    [[nodiscard]] std::optional<T> try_pop()
+    {
+        std::optional<T> value;
+        popInto([&value](T &&data) { value.emplace(std::move(data)); });
+        return value;
+    }
+
+    // Moves an element from the queue into value. Returns false, leaving value untouched, if the queue is empty.
+    [[nodiscard]] bool try_pop(T &value)
+    {
+        return popInto([&value](T &&data) { value = std::move(data); });
+    }
+
+    // Takes an element from the queue, blocking until one is available.
+    // The calling thread first spins briefly, then yields, and finally sleeps until a producer pushes, so it reacts
+    // quickly under load and does not use the CPU while the queue stays empty.
+    [[nodiscard]] T wait_pop()
+    {
+        std::optional<T> value;
+        waitPopInto([&value](T &&data) { value.emplace(std::move(data)); });
+        return std::move(*value);
+    }
+
+    // Moves an element from the queue into value, blocking until one is available
+    void wait_pop(T &value)
+    {
+        waitPopInto([&value](T &&data) { value = std::move(data); });
+    }
+
+    // Push data to the queue
+    void push(const T &data)
+    {
+        link(createNode(data));
+        not_empty_.notifyOne();
+    }
+
+    // Move data to the queue
+    void push(T &&data)
+    {
+        link(createNode(std::move(data)));
+        not_empty_.notifyOne();
+    }
+
+    // Construct data in place at the end of the queue
+    template <typename... Args> void emplace(Args &&...args)
+    {
+        link(createNode(std::forward<Args>(args)...));
+        not_empty_.notifyOne();
+    }
+
+    // Preallocates nodes for at least count elements in the pool shared by all queues of this type
+    static void reserveNodes(std::size_t count)
+    {
+        NodeAllocator::reserve(count);
+    }
+
+    // Allocation counters of the node pool shared by all queues of this type
+    [[nodiscard]] static NodePoolStatistics nodePoolStatistics() noexcept
+    {
+        return NodeAllocator::statistics();
+    }
+
+    // Check if the queue contains any elements
+    bool empty()
+    {
+        HazardPointer head_hazard;
+        return (head_hazard.protect(head_)->next.load(std::memory_order_acquire) == nullptr);
+    }
+
+  private:
+    // Unlinks the first Node holding data and passes the data to consume as an rvalue.
+    // Returns false if the queue is empty.
+    template <typename Consume> bool popInto(Consume &&consume)
+    {
+        // Hazard pointers keep the head and its successor alive while this thread dereferences them,
+        // even if another consumer pops and retires them concurrently.
+        HazardPointer head_hazard;
+        HazardPointer next_hazard;
 
         // An infinite loop that tries to pop the head Node.
         // It only exits the loop when it successfully pops the Node.
         for (;;)
         {
-            // Save the tail and next Node after the head.
+            // Protect the current head, then save the tail and next Node after the head.
+            Node *old_head = head_hazard.protect(head_);
             Node *tail = tail_.load(std::memory_order_acquire);
             Node *next = old_head->next.load(std::memory_order_acquire);
+            next_hazard.reset(next);
+
+            // If the head has changed, next may have been popped and retired before it was protected.
+            if (old_head != head_.load(std::memory_order_acquire))
+            {
+                continue;
+            }
 
-            // If there is no next Node, the queue is indeed empty and we return an empty pointer.
+            // If there is no next Node, the queue is indeed empty.
             if (next == nullptr)
             {
-                return nullptr;
+                return false;
             }
 
-            // If the head hasn't changed while saving tail and next.
-            if (old_head == head_.load(std::memory_order_relaxed))
+            // If head and tail are the same while there is a next Node, another thread has pushed a new Node to the
+            // queue but has not moved the tail yet, so we help it by moving the tail to the next Node.
+            if (old_head == tail)
             {
-                // If head and tail are the same, it means the queue might be empty.
-                if (old_head == tail)
+                tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Try to move the head to the next Node. If successful, next becomes the new dummy Node and its data
+            // is ours to take. It stays protected until we have moved the data out, so it is safe to access after
+            // the swap, and no other thread touches the data of a dummy Node.
+            if (head_.compare_exchange_strong(old_head, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                head_hazard.reset();
+                HazardPointerDomain::instance().retire(old_head, &LockFreeQueue::destroyNode);
+
+                T *data = next->data();
+                try
                 {
-                    // If there is a next Node, it means another thread has pushed a new Node to the queue,
-                    // so we help it by moving the tail to the next Node.
-                    tail_.compare_exchange_weak(old_head, next, std::memory_order_release, std::memory_order_relaxed);
+                    consume(std::move(*data));
                 }
-                // If the head and tail are not the same, it means there is at least one Node in the queue.
-                // We create a unique_ptr to return the data.
-                else
+                catch (...)
                 {
-                    T data = next->data;
-
-                    // Try to move the head to the next Node.
-                    // If successful, delete the old head Node and return the data.
-                    if (head_.compare_exchange_strong(old_head, next, std::memory_order_release,
-                                                      std::memory_order_relaxed))
-                    {
-                        delete old_head;
-                        return std::make_unique<T>(data);
-                    }
+                    std::destroy_at(data);
+                    throw;
                 }
+                std::destroy_at(data);
+                return true;
             }
-            else
+        }
+    }
+
+    // Blocking variant of popInto(): spin, then yield, then sleep on the event count until an element is popped
+    template <typename Consume> void waitPopInto(Consume &&consume)
+    {
+        for (int i = 0; i < WAIT_POP_SPIN_ITERATIONS; ++i)
+        {
+            if (popInto(consume))
+            {
+                return;
+            }
+            cpuRelax();
+        }
+
+        for (int i = 0; i < WAIT_POP_YIELD_ITERATIONS; ++i)
+        {
+            if (popInto(consume))
+            {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        while (!popInto(consume))
+        {
+            const auto key = not_empty_.prepareWait();
+            if (popInto(consume))
             {
-                old_head = head_.load(std::memory_order_acquire);
+                not_empty_.cancelWait();
+                return;
             }
+            not_empty_.wait(key);
         }
     }
 
-    // Push data to the queue
-    void push(const T &data)
+    // Appends a Node holding data to the end of the queue
+    void link(Node *new_node)
     {
-        // Create a new Node with the data.
-        Node *new_node = new Node{data};
+        // The tail Node may be popped and retired by a consumer while we are linking after it.
+        HazardPointer tail_hazard;
 
         // Infinite loop that attempts to push the new node.
         // It only exits when the new node has been successfully added to the queue.
         for (;;)
         {
             // Refresh the tail value in case it has been changed by another thread.
-            Node *tail = tail_.load(std::memory_order_acquire);
+            Node *tail = tail_hazard.protect(tail_);
 
             Node *expected{nullptr};
 
@@ -133,24 +315,17 @@ template <typename T> class LockFreeQueue
                 // Try to move the tail to our new Node.
                 // If this fails, it doesn't matter because another thread will
                 // do it when it adds another Node or when it pops.
-                tail_.compare_exchange_weak(tail, new_node, std::memory_order_release, std::memory_order_relaxed);
+                tail_.compare_exchange_strong(tail, new_node, std::memory_order_release, std::memory_order_relaxed);
                 break;
             }
-            else
+            else if (expected != nullptr)
             {
                 // If we failed to set the next pointer of the tail, another thread has already
                 // added a node, so we should try to help by advancing the tail
-                tail_.compare_exchange_weak(tail, expected, std::memory_order_release, std::memory_order_relaxed);
+                tail_.compare_exchange_strong(tail, expected, std::memory_order_release, std::memory_order_relaxed);
             }
         }
     }
-
-    // Check if the queue contains any elements
-    bool empty()
-    {
-        std::atomic_thread_fence(std::memory_order_acquire); // Ensure we get the latest values
-        return (head_.load(std::memory_order_relaxed)->next.load(std::memory_order_relaxed) == nullptr);
-    }
 };
 } // namespace common_library::concurrency
 
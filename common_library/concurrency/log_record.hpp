@@ -0,0 +1,385 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_LOG_RECORD
+#define COMMON_LIBRARY_CONCURRENCY_LOG_RECORD
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Messages below this level are compiled out by the COMMON_LIBRARY_LOG_* macros: 0 (TRACE) keeps all of them, 6 (OFF)
+// removes all of them
+#ifndef COMMON_LIBRARY_LOG_MIN_LEVEL
+#define COMMON_LIBRARY_LOG_MIN_LEVEL 0
+#endif
+
+namespace common_library::concurrency
+{
+// Severity of a log message. The values are part of the binary log file format and must not change.
+enum class LogLevel : std::uint8_t
+{
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARNING = 3,
+    ERROR = 4,
+    CRITICAL = 5,
+    // Threshold only: disables all messages
+    OFF = 6
+};
+
+[[nodiscard]] inline const char *logLevelName(LogLevel level) noexcept
+{
+    switch (level)
+    {
+    case LogLevel::TRACE:
+        return "TRACE";
+    case LogLevel::DEBUG:
+        return "DEBUG";
+    case LogLevel::INFO:
+        return "INFO";
+    case LogLevel::WARNING:
+        return "WARNING";
+    case LogLevel::ERROR:
+        return "ERROR";
+    case LogLevel::CRITICAL:
+        return "CRITICAL";
+    default:
+        return "OFF";
+    }
+}
+
+// Whether messages of the level are kept by COMMON_LIBRARY_LOG_MIN_LEVEL
+[[nodiscard]] constexpr bool isLogLevelCompiledIn(LogLevel level) noexcept
+{
+    // Every level passes the default threshold of 0. The comparison against it is always true and warns
+    // (-Wtype-limits) even in a discarded if constexpr branch, so it is removed by the preprocessor.
+#if COMMON_LIBRARY_LOG_MIN_LEVEL > 0
+    return static_cast<int>(level) >= COMMON_LIBRARY_LOG_MIN_LEVEL;
+#else
+    static_cast<void>(level);
+    return true;
+#endif
+}
+
+// Type of a serialized log argument. The values are part of the binary log file format and must not change.
+enum class LogArgumentType : std::uint8_t
+{
+    // Length prefixed bytes: a std::uint32_t length followed by the characters
+    TEXT = 1,
+    BOOL = 2,
+    CHAR = 3,
+    INT16 = 4,
+    INT32 = 5,
+    INT64 = 6,
+    UINT16 = 7,
+    UINT32 = 8,
+    UINT64 = 9,
+    FLOAT = 10,
+    DOUBLE = 11,
+    LONG_DOUBLE = 12,
+    POINTER = 13,
+    // Any other value stored as it is, such as an enum or std::thread::id, which only the logging process knows how to
+    // format
+    OPAQUE = 14
+};
+
+// Writes one serialized value, or a whole serialized message, to a stream
+using LogFormatFunction = void (*)(const unsigned char *data, std::ostream &stream);
+
+// Description of one argument of a log message
+struct LogArgument
+{
+    LogArgumentType type;
+    // Size of the serialized value; zero for TEXT
+    std::uint32_t size;
+    LogFormatFunction format;
+};
+
+// Description of the arguments of a log message, shared by all messages logged with the same argument types
+struct LogFormat
+{
+    // Formats the whole payload
+    LogFormatFunction format;
+    // Releases what the payload owns; nullptr if it owns nothing
+    void (*destroy)(const unsigned char *payload);
+    // Copies a payload into another record, duplicating what it owns; nullptr if a bytewise copy is enough
+    void (*copy)(const unsigned char *source, unsigned char *destination);
+    std::size_t argument_count;
+    const LogArgument *arguments;
+};
+
+// Fixed-size unit of the logger's per-thread ring buffers
+struct LogRecord
+{
+    static constexpr std::size_t SIZE = 128U;
+
+    const LogFormat *format;
+    // CycleClock ticks at the time of the log() call
+    std::uint64_t timestamp;
+    LogLevel level;
+    unsigned char payload[SIZE - sizeof(const LogFormat *) - sizeof(std::uint64_t) - sizeof(LogLevel)];
+};
+
+static_assert(sizeof(LogRecord) == LogRecord::SIZE, "LogRecord must not contain padding");
+
+// Stream buffer appending to a string, so that formatting into a reused string does not allocate per message
+class StringStreamBuffer final : public std::streambuf
+{
+  public:
+    explicit StringStreamBuffer(std::string &output) : output_(output)
+    {
+    }
+
+  protected:
+    int_type overflow(int_type character) override
+    {
+        if (!traits_type::eq_int_type(character, traits_type::eof()))
+        {
+            output_.push_back(traits_type::to_char_type(character));
+        }
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char_type *data, std::streamsize count) override
+    {
+        output_.append(data, static_cast<std::size_t>(count));
+        return count;
+    }
+
+  private:
+    std::string &output_;
+};
+
+// Serialization of log() arguments into LogRecord payloads.
+//
+// Arguments are stored as follows:
+// - strings (std::string, std::string_view, C strings) are copied as length prefixed bytes,
+// - numbers, enums, void pointers, nullptr and std::thread::id are copied as they are,
+// - any other type is formatted by the caller and stored as a string. This includes trivially copyable types that
+//   may point to other memory, e.g. std::reference_wrapper or a struct holding a const char *, which the caller may
+//   free or change before the worker formats them.
+class LogSerializer final
+{
+  public:
+    static constexpr std::size_t PAYLOAD_SIZE = sizeof(LogRecord::payload);
+
+    LogSerializer() = delete;
+
+    // Converts an argument into the value stored in the payload: a view of a string, the argument itself if it can be
+    // formatted later from a copy of its bytes, or the argument formatted by the caller
+    template <typename Arg> static decltype(auto) toStored(const Arg &arg)
+    {
+        if constexpr (IS_STORED_AS_IS<Arg> && (sizeof(Arg) <= PAYLOAD_SIZE))
+        {
+            // Checked first: nullptr converts to std::string_view as a null C string
+            return arg;
+        }
+        else if constexpr (std::is_pointer_v<Arg> && std::is_convertible_v<Arg, std::string_view>)
+        {
+            return (arg != nullptr) ? std::string_view{arg} : std::string_view{};
+        }
+        else if constexpr (std::is_convertible_v<const Arg &, std::string_view>)
+        {
+            return std::string_view{arg};
+        }
+        else
+        {
+            std::ostringstream stream;
+            stream << arg;
+            return stream.str();
+        }
+    }
+
+    // Number of payload bytes needed to serialize the stored values
+    template <typename... Values> [[nodiscard]] static std::size_t encodedSize(const Values &...values) noexcept
+    {
+        return (valueSize(values) + ... + 0U);
+    }
+
+    // Serializes the stored values into a payload of at least encodedSize(values...) bytes and returns their format
+    template <typename... Values>
+    static const LogFormat *encode(unsigned char *payload, const Values &...values) noexcept
+    {
+        unsigned char *cursor = payload;
+        (encodeValue(cursor, values), ...);
+        return &FormatOf<Values...>::FORMAT;
+    }
+
+    // Stores a message that was formatted by the caller because it does not fit into a payload. The payload owns the
+    // string until the format's destroy function is called.
+    static const LogFormat *encodeOversized(unsigned char *payload, std::string message)
+    {
+        auto *text = new std::string(std::move(message));
+        std::memcpy(payload, &text, sizeof(text));
+        return &OVERSIZED_FORMAT;
+    }
+
+  private:
+    // Types whose value alone determines what operator<< prints, without reading memory they point to
+    template <typename Arg>
+    static constexpr bool IS_STORED_AS_IS =
+        std::is_arithmetic_v<Arg> || std::is_enum_v<Arg> || std::is_same_v<Arg, const void *> ||
+        std::is_same_v<Arg, void *> || std::is_same_v<Arg, std::nullptr_t> || std::is_same_v<Arg, std::thread::id>;
+
+    template <typename Value>
+    static constexpr bool IS_TEXT = std::is_same_v<Value, std::string_view> || std::is_same_v<Value, std::string>;
+
+    // Type of a stored value, chosen so that an offline decoder prints it exactly like operator<< does
+    template <typename Value> static constexpr LogArgumentType argumentType() noexcept
+    {
+        if constexpr (IS_TEXT<Value>)
+        {
+            return LogArgumentType::TEXT;
+        }
+        else if constexpr (std::is_same_v<Value, bool>)
+        {
+            return LogArgumentType::BOOL;
+        }
+        else if constexpr (std::is_same_v<Value, char> || std::is_same_v<Value, signed char> ||
+                           std::is_same_v<Value, unsigned char>)
+        {
+            return LogArgumentType::CHAR;
+        }
+        else if constexpr (std::is_integral_v<Value> && (sizeof(Value) == 2U || sizeof(Value) == 4U ||
+                                                         sizeof(Value) == 8U))
+        {
+            constexpr LogArgumentType SIGNED[] = {LogArgumentType::INT16, LogArgumentType::INT32,
+                                                  LogArgumentType::INT64};
+            constexpr LogArgumentType UNSIGNED[] = {LogArgumentType::UINT16, LogArgumentType::UINT32,
+                                                    LogArgumentType::UINT64};
+            constexpr std::size_t INDEX = (sizeof(Value) == 2U) ? 0U : ((sizeof(Value) == 4U) ? 1U : 2U);
+            return std::is_signed_v<Value> ? SIGNED[INDEX] : UNSIGNED[INDEX];
+        }
+        else if constexpr (std::is_same_v<Value, float>)
+        {
+            return LogArgumentType::FLOAT;
+        }
+        else if constexpr (std::is_same_v<Value, double>)
+        {
+            return LogArgumentType::DOUBLE;
+        }
+        else if constexpr (std::is_same_v<Value, long double>)
+        {
+            return LogArgumentType::LONG_DOUBLE;
+        }
+        else if constexpr (std::is_same_v<Value, const void *> || std::is_same_v<Value, void *>)
+        {
+            return LogArgumentType::POINTER;
+        }
+        else
+        {
+            return LogArgumentType::OPAQUE;
+        }
+    }
+
+    template <typename Value> static std::size_t valueSize(const Value &value) noexcept
+    {
+        if constexpr (IS_TEXT<Value>)
+        {
+            return sizeof(std::uint32_t) + value.size();
+        }
+        else
+        {
+            return sizeof(Value);
+        }
+    }
+
+    template <typename Value> static void encodeValue(unsigned char *&cursor, const Value &value) noexcept
+    {
+        if constexpr (IS_TEXT<Value>)
+        {
+            const auto length = static_cast<std::uint32_t>(value.size());
+            std::memcpy(cursor, &length, sizeof(length));
+            if (length > 0U)
+            {
+                std::memcpy(cursor + sizeof(length), value.data(), length);
+            }
+            cursor += sizeof(length) + length;
+        }
+        else
+        {
+            std::memcpy(cursor, &value, sizeof(Value));
+            cursor += sizeof(Value);
+        }
+    }
+
+    // Writes the value serialized at the cursor and advances the cursor past it
+    template <typename Value> static void decodeValue(const unsigned char *&cursor, std::ostream &stream)
+    {
+        if constexpr (IS_TEXT<Value>)
+        {
+            std::uint32_t length;
+            std::memcpy(&length, cursor, sizeof(length));
+            stream.write(reinterpret_cast<const char *>(cursor + sizeof(length)), length);
+            cursor += sizeof(length) + length;
+        }
+        else
+        {
+            alignas(Value) unsigned char storage[sizeof(Value)];
+            std::memcpy(storage, cursor, sizeof(Value));
+            stream << *std::launder(reinterpret_cast<const Value *>(storage));
+            cursor += sizeof(Value);
+        }
+    }
+
+    template <typename Value> static void formatValue(const unsigned char *data, std::ostream &stream)
+    {
+        decodeValue<Value>(data, stream);
+    }
+
+    template <typename... Values> static void formatPayload(const unsigned char *payload, std::ostream &stream)
+    {
+        const unsigned char *cursor = payload;
+        (decodeValue<Values>(cursor, stream), ...);
+    }
+
+    // One LogFormat per combination of stored value types
+    template <typename... Values> struct FormatOf
+    {
+        static constexpr std::array<LogArgument, sizeof...(Values)> ARGUMENTS{
+            {LogArgument{argumentType<Values>(), IS_TEXT<Values> ? 0U : static_cast<std::uint32_t>(sizeof(Values)),
+                         &LogSerializer::formatValue<Values>}...}};
+
+        static constexpr LogFormat FORMAT{&LogSerializer::formatPayload<Values...>, nullptr, nullptr, sizeof...(Values),
+                                          ARGUMENTS.data()};
+    };
+
+    static void formatOversized(const unsigned char *payload, std::ostream &stream)
+    {
+        const std::string *message;
+        std::memcpy(&message, payload, sizeof(message));
+        stream << *message;
+    }
+
+    static void copyOversized(const unsigned char *source, unsigned char *destination)
+    {
+        const std::string *message;
+        std::memcpy(&message, source, sizeof(message));
+        auto *copy = new std::string(*message);
+        std::memcpy(destination, &copy, sizeof(copy));
+    }
+
+    static void destroyOversized(const unsigned char *payload)
+    {
+        const std::string *message;
+        std::memcpy(&message, payload, sizeof(message));
+        delete message;
+    }
+
+    static constexpr LogArgument OVERSIZED_ARGUMENT{LogArgumentType::OPAQUE, sizeof(std::string *),
+                                                    &LogSerializer::formatOversized};
+
+    static constexpr LogFormat OVERSIZED_FORMAT{&LogSerializer::formatOversized, &LogSerializer::destroyOversized,
+                                                &LogSerializer::copyOversized, 1U, &OVERSIZED_ARGUMENT};
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_LOG_RECORD
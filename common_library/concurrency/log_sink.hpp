@@ -0,0 +1,574 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_LOG_SINK
+#define COMMON_LIBRARY_CONCURRENCY_LOG_SINK
+
+#include <common_library/concurrency/binary_log.hpp>
+#include <common_library/concurrency/event_count.hpp>
+#include <common_library/concurrency/log_record.hpp>
+#include <common_library/concurrency/single_producer_single_consumer_queue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace common_library::concurrency
+{
+// Messages handed to the sinks at once. The batch owns its records and releases what they own in clear().
+class LogBatch final
+{
+  public:
+    LogBatch() = default;
+    LogBatch(const LogBatch &other) = delete;
+    LogBatch(LogBatch &&other) noexcept = delete;
+    LogBatch &operator=(const LogBatch &other) = delete;
+    LogBatch &operator=(LogBatch &&other) noexcept = delete;
+
+    ~LogBatch()
+    {
+        clear();
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return records_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return records_.empty();
+    }
+
+    [[nodiscard]] const LogRecord &record(std::size_t index) const noexcept
+    {
+        return records_[index];
+    }
+
+    // Operating system id of the thread that logged the record
+    [[nodiscard]] std::uint32_t threadId(std::size_t index) const noexcept
+    {
+        return thread_ids_[index];
+    }
+
+    // The messages as text, one "[LEVEL] message" line each. Formatted on the first call only, so that all text
+    // sinks share the work.
+    [[nodiscard]] const std::string &text() const
+    {
+        if (!formatted_)
+        {
+            for (const LogRecord &record : records_)
+            {
+                text_.push_back('[');
+                text_.append(logLevelName(record.level));
+                text_.append("] ");
+                record.format->format(record.payload, text_stream_);
+                text_.push_back('\n');
+            }
+            formatted_ = true;
+        }
+        return text_;
+    }
+
+    // Takes over the record and what it owns
+    void push(const LogRecord &record, std::uint32_t thread_id)
+    {
+        records_.push_back(record);
+        thread_ids_.push_back(thread_id);
+        formatted_ = false;
+        text_.clear();
+    }
+
+    // Releases what the records own and empties the batch, keeping its memory for the next batch
+    void clear() noexcept
+    {
+        for (const LogRecord &record : records_)
+        {
+            if (record.format->destroy != nullptr)
+            {
+                record.format->destroy(record.payload);
+            }
+        }
+        records_.clear();
+        thread_ids_.clear();
+        text_.clear();
+        formatted_ = false;
+    }
+
+  private:
+    std::vector<LogRecord> records_;
+    std::vector<std::uint32_t> thread_ids_;
+
+    mutable bool formatted_{false};
+    mutable std::string text_;
+    mutable StringStreamBuffer text_buffer_{text_};
+    mutable std::ostream text_stream_{&text_buffer_};
+};
+
+// Destination of log messages. The logger calls write() and flush() from its worker thread only.
+class LogSink
+{
+  public:
+    LogSink() = default;
+    LogSink(const LogSink &other) = delete;
+    LogSink(LogSink &&other) noexcept = delete;
+    LogSink &operator=(const LogSink &other) = delete;
+    LogSink &operator=(LogSink &&other) noexcept = delete;
+    virtual ~LogSink() = default;
+
+    // Delivers the batch. The records are only valid during the call.
+    virtual void write(const LogBatch &batch) = 0;
+
+    // Blocks until the batches written so far have been delivered
+    virtual void flush()
+    {
+    }
+};
+
+// Writes the text of each batch to a file descriptor with as few write(2) calls as possible
+class FileDescriptorLogSink : public LogSink
+{
+  public:
+    void write(const LogBatch &batch) override
+    {
+        writeAll(batch.text());
+    }
+
+  protected:
+    int descriptor_;
+
+    explicit FileDescriptorLogSink(int descriptor) noexcept : descriptor_(descriptor)
+    {
+    }
+
+    // Returns false if the text could not be written completely
+    bool writeAll(std::string_view text) noexcept
+    {
+        while (!text.empty())
+        {
+            const ssize_t written = ::write(descriptor_, text.data(), text.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            text.remove_prefix(static_cast<std::size_t>(written));
+        }
+        return true;
+    }
+
+    // Opens a file for appending. Throws std::system_error on failure.
+    static int openForAppending(const std::string &path)
+    {
+        const int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (descriptor < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "Cannot open log file " + path);
+        }
+        return descriptor;
+    }
+};
+
+class StandardOutputLogSink final : public FileDescriptorLogSink
+{
+  public:
+    StandardOutputLogSink() noexcept : FileDescriptorLogSink(STDOUT_FILENO)
+    {
+    }
+};
+
+// Appends the messages to a text file. Throws std::system_error if the file cannot be opened.
+class FileLogSink final : public FileDescriptorLogSink
+{
+  public:
+    explicit FileLogSink(const std::string &path) : FileDescriptorLogSink(openForAppending(path))
+    {
+    }
+
+    ~FileLogSink() override
+    {
+        ::close(descriptor_);
+    }
+};
+
+// Appends the messages to a text file that is rotated by size: when the next line would make it larger than
+// max_file_size bytes, path becomes path.1, path.1 becomes path.2, and so on, keeping at most max_files files. A line
+// longer than max_file_size gets a file of its own. Throws std::system_error if the file cannot be opened.
+//
+// write() throws std::system_error if the file cannot be written or reopened after a rotation; the logger reports the
+// error. A file that could not be reopened, e.g. for lack of descriptors, is opened again by the next write().
+class RotatingFileLogSink final : public FileDescriptorLogSink
+{
+  public:
+    RotatingFileLogSink(std::string path, std::size_t max_file_size, std::size_t max_files)
+        : FileDescriptorLogSink(-1), path_(std::move(path)), max_file_size_(max_file_size), max_files_(max_files)
+    {
+        open();
+    }
+
+    ~RotatingFileLogSink() override
+    {
+        if (descriptor_ >= 0)
+        {
+            ::close(descriptor_);
+        }
+    }
+
+    void write(const LogBatch &batch) override
+    {
+        if (descriptor_ < 0)
+        {
+            open();
+        }
+
+        std::string_view text = batch.text();
+        while (!text.empty())
+        {
+            // Write as many whole lines as fit into the file, at least one
+            std::size_t size = text.size();
+            if (file_size_ + size > max_file_size_)
+            {
+                const std::size_t space = (max_file_size_ > file_size_) ? (max_file_size_ - file_size_) : 0U;
+                const std::size_t line_end = (space > 0U) ? text.rfind('\n', space - 1U) : std::string_view::npos;
+                if (line_end != std::string_view::npos)
+                {
+                    size = line_end + 1U;
+                }
+                else if (file_size_ > 0U)
+                {
+                    rotate();
+                    continue;
+                }
+                else
+                {
+                    size = text.find('\n') + 1U;
+                }
+            }
+
+            if (!writeAll(text.substr(0U, size)))
+            {
+                throw std::system_error(errno, std::generic_category(), "Cannot write log file " + path_);
+            }
+            file_size_ += size;
+            text.remove_prefix(size);
+        }
+    }
+
+  private:
+    std::string path_;
+    std::size_t max_file_size_;
+    std::size_t max_files_;
+    std::size_t file_size_{0U};
+
+    // Opens path_ for appending and continues its size. Throws std::system_error on failure.
+    void open()
+    {
+        descriptor_ = openForAppending(path_);
+        const off_t size = ::lseek(descriptor_, 0, SEEK_END);
+        file_size_ = (size > 0) ? static_cast<std::size_t>(size) : 0U;
+    }
+
+    void rotate()
+    {
+        ::close(descriptor_);
+        descriptor_ = -1;
+        rotateLogFiles(path_, max_files_);
+        open();
+    }
+};
+
+// Keeps the most recent capacity bytes of text in memory, e.g. to be dumped by a crash handler
+class MemoryLogSink final : public LogSink
+{
+  public:
+    explicit MemoryLogSink(std::size_t capacity) : buffer_(capacity)
+    {
+        if (capacity == 0U)
+        {
+            throw std::invalid_argument("MemoryLogSink: capacity must be positive");
+        }
+    }
+
+    void write(const LogBatch &batch) override
+    {
+        std::string_view text = batch.text();
+        const std::lock_guard<std::mutex> lock{mutex_};
+        if (text.size() > buffer_.size())
+        {
+            text.remove_prefix(text.size() - buffer_.size());
+        }
+
+        const std::size_t first = std::min(text.size(), buffer_.size() - position_);
+        std::memcpy(buffer_.data() + position_, text.data(), first);
+        std::memcpy(buffer_.data(), text.data() + first, text.size() - first);
+        position_ = (position_ + text.size()) % buffer_.size();
+        size_ = std::min(size_ + text.size(), buffer_.size());
+    }
+
+    // Returns the retained text, oldest first. The first line may be cut.
+    [[nodiscard]] std::string contents() const
+    {
+        const std::lock_guard<std::mutex> lock{mutex_};
+        std::string contents;
+        contents.reserve(size_);
+        const std::size_t start = (position_ + buffer_.size() - size_) % buffer_.size();
+        const std::size_t first = std::min(size_, buffer_.size() - start);
+        contents.append(buffer_.data() + start, first);
+        contents.append(buffer_.data(), size_ - first);
+        return contents;
+    }
+
+    // Writes the retained text to a file descriptor without locking or allocating, so that it can be called from a
+    // signal handler. The text may be torn if the logger writes at the same time.
+    void dump(int descriptor) const noexcept
+    {
+        const std::size_t size = size_;
+        const std::size_t start = (position_ + buffer_.size() - size) % buffer_.size();
+        const std::size_t first = std::min(size, buffer_.size() - start);
+        static_cast<void>(::write(descriptor, buffer_.data() + start, first));
+        static_cast<void>(::write(descriptor, buffer_.data(), size - first));
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::vector<char> buffer_;
+    // Where the next byte is written
+    std::size_t position_{0U};
+    std::size_t size_{0U};
+};
+
+// Sends the text to a UDP port of the local host, e.g. to a log collector. Datagrams hold whole lines, up to
+// MAX_DATAGRAM_SIZE bytes; the socket never blocks, so datagrams are dropped if the receiver cannot keep up.
+// Throws std::system_error if the socket cannot be created.
+class UdpLogSink final : public LogSink
+{
+  public:
+    static constexpr std::size_t MAX_DATAGRAM_SIZE = 8U * 1024U;
+
+    explicit UdpLogSink(std::uint16_t port) : descriptor_(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0))
+    {
+        if (descriptor_ < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "UdpLogSink: cannot create a socket");
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(descriptor_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            const int error = errno;
+            ::close(descriptor_);
+            throw std::system_error(error, std::generic_category(), "UdpLogSink: cannot connect the socket");
+        }
+    }
+
+    ~UdpLogSink() override
+    {
+        ::close(descriptor_);
+    }
+
+    void write(const LogBatch &batch) override
+    {
+        std::string_view text = batch.text();
+        while (!text.empty())
+        {
+            std::size_t size = std::min(text.size(), MAX_DATAGRAM_SIZE);
+            if (size < text.size())
+            {
+                // Cut after the last complete line, unless a single line is longer than a datagram
+                const std::size_t line_end = text.rfind('\n', size - 1U);
+                if (line_end != std::string_view::npos)
+                {
+                    size = line_end + 1U;
+                }
+            }
+            static_cast<void>(::send(descriptor_, text.data(), size, MSG_DONTWAIT | MSG_NOSIGNAL));
+            text.remove_prefix(size);
+        }
+    }
+
+  private:
+    int descriptor_;
+};
+
+// Writes the records to memory-mapped binary log files, see BinaryLogWriter
+class BinaryLogSink final : public LogSink
+{
+  public:
+    BinaryLogSink(std::string path, std::size_t max_file_size, std::size_t max_files)
+        : writer_(std::move(path), max_file_size, max_files)
+    {
+    }
+
+    void write(const LogBatch &batch) override
+    {
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            writer_.write(batch.record(i), batch.threadId(i));
+        }
+    }
+
+  private:
+    BinaryLogWriter writer_;
+};
+
+// Runs a slow sink on its own thread, so that it cannot hold back the logger's worker and the other sinks.
+//
+// write() copies the records into a ring of capacity records and returns; the sink's thread writes them to the
+// wrapped sink in batches. Records that do not fit into the ring are dropped and counted.
+class AsyncLogSink final : public LogSink
+{
+  public:
+    AsyncLogSink(std::unique_ptr<LogSink> sink, std::size_t capacity)
+        : sink_(std::move(sink)), entries_(capacity), worker_(&AsyncLogSink::processEntries, this)
+    {
+    }
+
+    ~AsyncLogSink() override
+    {
+        exit_.store(true, std::memory_order_release);
+        wake_.notifyAll();
+        worker_.join();
+    }
+
+    void write(const LogBatch &batch) override
+    {
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            Entry *entry = entries_.try_reserve();
+            if (entry == nullptr)
+            {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + (batch.size() - i),
+                               std::memory_order_relaxed);
+                break;
+            }
+
+            const LogRecord &record = batch.record(i);
+            entry->record = record;
+            if (record.format->copy != nullptr)
+            {
+                record.format->copy(record.payload, entry->record.payload);
+            }
+            entry->thread_id = batch.threadId(i);
+            entries_.commit();
+        }
+        wake_.notifyOne();
+    }
+
+    void flush() override
+    {
+        std::unique_lock<std::mutex> lock{flush_mutex_};
+        const std::uint64_t request = flush_requested_.fetch_add(1U, std::memory_order_acq_rel) + 1U;
+        wake_.notifyAll();
+        flush_condition_.wait(lock, [this, request]() { return flush_completed_ >= request; });
+        lock.unlock();
+        sink_->flush();
+    }
+
+    // Number of messages dropped because the ring was full
+    [[nodiscard]] std::uint64_t droppedMessages() const noexcept
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::size_t DRAIN_BATCH_SIZE = 256U;
+
+    struct Entry
+    {
+        LogRecord record;
+        std::uint32_t thread_id;
+    };
+
+    std::unique_ptr<LogSink> sink_;
+    // Filled by the logger's worker, drained by worker_
+    SingleProducerSingleConsumerQueue<Entry, true> entries_;
+    std::atomic_uint64_t dropped_{0U};
+
+    EventCount wake_;
+    std::atomic_bool exit_{false};
+
+    std::atomic_uint64_t flush_requested_{0U};
+    std::uint64_t flush_completed_{0U};
+    std::mutex flush_mutex_;
+    std::condition_variable flush_condition_;
+
+    std::thread worker_;
+
+    void processEntries()
+    {
+        LogBatch batch;
+        for (;;)
+        {
+            const bool exiting = exit_.load(std::memory_order_acquire);
+            const std::uint64_t flush_requested = flush_requested_.load(std::memory_order_acquire);
+
+            const auto span = entries_.peek(DRAIN_BATCH_SIZE);
+            if (!span.empty())
+            {
+                for (const Entry &entry : span)
+                {
+                    batch.push(entry.record, entry.thread_id);
+                }
+                entries_.release(span.size);
+
+                // A sink that throws loses the batch, there is nobody to report the error to
+                try
+                {
+                    sink_->write(batch);
+                }
+                catch (const std::exception &)
+                {
+                }
+                batch.clear();
+                continue;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{flush_mutex_};
+                if (flush_completed_ != flush_requested)
+                {
+                    flush_completed_ = flush_requested;
+                    flush_condition_.notify_all();
+                }
+            }
+            if (exiting)
+            {
+                break;
+            }
+
+            const auto key = wake_.prepareWait();
+            if (exit_.load(std::memory_order_acquire) ||
+                (flush_requested_.load(std::memory_order_acquire) != flush_requested) || (entries_.peek() != nullptr))
+            {
+                wake_.cancelWait();
+                continue;
+            }
+            wake_.wait(key);
+        }
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_LOG_SINK
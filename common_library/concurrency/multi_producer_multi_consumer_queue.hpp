@@ -0,0 +1,279 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
+#define COMMON_LIBRARY_CONCURRENCY_MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
+
+#include <common_library/concurrency/cache_line.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace common_library::concurrency
+{
+// Bounded Multi Producer Multi Consumer Queue
+//
+// Lock-free array queue after Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number that tells
+// producers and consumers whether the cell is free for the position they claimed, so a push or a pop costs a single
+// CAS on the shared position counter in the uncontended case. All memory is allocated in the constructor.
+//
+// tryPush/tryPop follow the semantics of BoundedSharedQueue::tryPush/tryPop: they never block and return false if the
+// queue is full or empty, respectively.
+//
+// If constructing an item throws after its cell was claimed, the cell is published as abandoned and consumers skip it,
+// so the exception propagates to the producer without blocking the queue. If moving an item out throws, the item is
+// destroyed and its cell freed before the exception propagates to the consumer.
+template <typename T> class MultiProducerMultiConsumerQueue final
+{
+  private:
+    struct Cell
+    {
+        // 2 * position while the cell is free for the push of position, 2 * position + 1 once it holds that item.
+        // Doubling keeps the two states apart even in a queue of a single cell.
+        std::atomic_size_t sequence;
+        // Set when the construction of the item for the current position threw. Published by sequence like the item.
+        bool abandoned{false};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    const std::size_t max_size_;
+    // Set when max_size_ is a power of two, so positions are wrapped with a mask instead of a modulo
+    const bool power_of_two_;
+    const std::unique_ptr<Cell[]> buffer_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t enqueue_position_;
+    alignas(CACHE_LINE_SIZE) std::atomic_size_t dequeue_position_;
+
+  public:
+    // Largest max_size whose cells fit into the address space, though allocating them would fail long before
+    static constexpr std::size_t MAX_SIZE =
+        static_cast<std::size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(Cell);
+
+    // Throws std::invalid_argument if max_size is zero
+    explicit MultiProducerMultiConsumerQueue(std::size_t max_size)
+        : max_size_(max_size), power_of_two_((max_size & (max_size - 1U)) == 0U), buffer_(new Cell[max_size]),
+          enqueue_position_(0), dequeue_position_(0)
+    {
+        if (max_size == 0U)
+        {
+            throw std::invalid_argument("MultiProducerMultiConsumerQueue: max_size must be positive");
+        }
+        for (std::size_t i = 0; i < max_size_; ++i)
+        {
+            buffer_[i].sequence.store(2U * i, std::memory_order_relaxed);
+        }
+    }
+
+    MultiProducerMultiConsumerQueue() = delete;
+    MultiProducerMultiConsumerQueue(const MultiProducerMultiConsumerQueue &other) = delete;
+    MultiProducerMultiConsumerQueue(MultiProducerMultiConsumerQueue &&other) noexcept = delete;
+    MultiProducerMultiConsumerQueue &operator=(const MultiProducerMultiConsumerQueue &other) = delete;
+    MultiProducerMultiConsumerQueue &operator=(MultiProducerMultiConsumerQueue &&other) noexcept = delete;
+
+    ~MultiProducerMultiConsumerQueue()
+    {
+        const std::size_t enqueue_position = enqueue_position_.load(std::memory_order_acquire);
+        std::size_t position = dequeue_position_.load(std::memory_order_acquire);
+        for (; position != enqueue_position; ++position)
+        {
+            Cell &cell = buffer_[index(position)];
+            if (!cell.abandoned)
+            {
+                front(&cell)->~T();
+            }
+        }
+    }
+
+    // Constructs an item in place from the arguments. Returns false if the queue is full. Rethrows an exception thrown
+    // by the constructor of T, leaving the queue usable.
+    template <typename... Args> [[nodiscard]] bool tryEmplace(Args &&...args)
+    {
+        Cell *cell;
+        std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &buffer_[index(position)];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - 2U * position);
+
+            // The cell is free for this position: try to claim it
+            if (difference == 0)
+            {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            // The cell still holds the item pushed one lap ago: the queue is full
+            else if (difference < 0)
+            {
+                return false;
+            }
+            // Another producer claimed the position: reload it
+            else
+            {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+
+        try
+        {
+            ::new (static_cast<void *>(cell->storage)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            // Consumers wait for the cell of every claimed position: hand it over without an item
+            cell->abandoned = true;
+            cell->sequence.store(2U * position + 1U, std::memory_order_release);
+            throw;
+        }
+        cell->sequence.store(2U * position + 1U, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool tryPush(const T &item)
+    {
+        return tryEmplace(item);
+    }
+
+    [[nodiscard]] bool tryPush(T &&item)
+    {
+        return tryEmplace(std::move(item));
+    }
+
+    // Moves the oldest item out of the queue. Returns false if the queue is empty.
+    [[nodiscard]] bool tryPop(T &item)
+    {
+        std::size_t position;
+        Cell *cell = claimFront(position);
+        if (cell == nullptr)
+        {
+            return false;
+        }
+
+        try
+        {
+            item = std::move(*front(cell));
+        }
+        catch (...)
+        {
+            releaseFront(cell, position);
+            throw;
+        }
+        releaseFront(cell, position);
+        return true;
+    }
+
+    // Moves the oldest item out of the queue, for types that are not default constructible. Returns std::nullopt if
+    // the queue is empty.
+    [[nodiscard]] std::optional<T> tryPop()
+    {
+        std::size_t position;
+        Cell *cell = claimFront(position);
+        if (cell == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<T> item;
+        try
+        {
+            item.emplace(std::move(*front(cell)));
+        }
+        catch (...)
+        {
+            releaseFront(cell, position);
+            throw;
+        }
+        releaseFront(cell, position);
+        return item;
+    }
+
+    [[nodiscard]] std::size_t maxSize() const noexcept
+    {
+        return max_size_;
+    }
+
+    // The observers below are exact only when no other thread is pushing or popping at the same time.
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        const std::size_t dequeue_position = dequeue_position_.load(std::memory_order_acquire);
+        const std::size_t enqueue_position = enqueue_position_.load(std::memory_order_acquire);
+        return (enqueue_position > dequeue_position) ? (enqueue_position - dequeue_position) : 0U;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return (size() == 0U);
+    }
+
+    [[nodiscard]] bool full() const noexcept
+    {
+        return (size() >= max_size_);
+    }
+
+  private:
+    // Claims the cell of the oldest item and stores its position, releasing abandoned cells on the way. Returns nullptr
+    // if the queue is empty.
+    [[nodiscard]] Cell *claimFront(std::size_t &position) noexcept
+    {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell *cell = &buffer_[index(position)];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - (2U * position + 1U));
+
+            // The cell holds the item for this position: try to claim it
+            if (difference == 0)
+            {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed))
+                {
+                    if (!cell->abandoned)
+                    {
+                        return cell;
+                    }
+                    cell->abandoned = false;
+                    cell->sequence.store(2U * (position + max_size_), std::memory_order_release);
+                    position = dequeue_position_.load(std::memory_order_relaxed);
+                }
+            }
+            // The cell has not been written for this position yet: the queue is empty
+            else if (difference < 0)
+            {
+                return nullptr;
+            }
+            // Another consumer claimed the position: reload it
+            else
+            {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] static T *front(Cell *cell) noexcept
+    {
+        return std::launder(reinterpret_cast<T *>(cell->storage));
+    }
+
+    // Destroys the item of a claimed cell and frees the cell for the push one lap later
+    void releaseFront(Cell *cell, std::size_t position) noexcept
+    {
+        front(cell)->~T();
+        cell->sequence.store(2U * (position + max_size_), std::memory_order_release);
+    }
+
+    [[nodiscard]] std::size_t index(std::size_t position) const noexcept
+    {
+        return power_of_two_ ? (position & (max_size_ - 1U)) : (position % max_size_);
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
@@ -0,0 +1,269 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_NODE_POOL
+#define COMMON_LIBRARY_CONCURRENCY_NODE_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace common_library::concurrency
+{
+// Counters of a NodePool, used to verify that a steady-state workload does not reach the global allocator
+struct NodePoolStatistics
+{
+    // Blocks obtained from the global allocator
+    std::size_t global_allocations;
+    // Batches of blocks taken from the shared depot by a thread cache that ran empty
+    std::size_t depot_refills;
+    // Batches of blocks handed to the shared depot by a thread cache that grew too large
+    std::size_t depot_spills;
+};
+
+// Fixed-size block allocator for the nodes of lock-free containers.
+//
+// Every thread allocates from and frees to its own cache without synchronization. Caches exchange blocks with a shared
+// depot in batches of BATCH_SIZE, so the depot mutex is taken at most once per BATCH_SIZE operations, and the global
+// allocator is only called when the depot is empty. The depot links the batches through their first blocks, so
+// handing blocks back never allocates and deallocate() cannot fail. Blocks are never returned to the global allocator
+// before the program exits, so the pool size settles at the high-water mark of the workload.
+//
+// The pool recycles memory immediately: lock-free containers must only deallocate a node once no other thread can
+// access it anymore, e.g. from a HazardPointerDomain deleter.
+template <typename T> class NodePool final
+{
+  public:
+    static constexpr std::size_t BATCH_SIZE = 128U;
+    static constexpr std::size_t THREAD_CACHE_LIMIT = 2U * BATCH_SIZE;
+
+    NodePool() = delete;
+
+    // Returns uninitialized storage for one T
+    [[nodiscard]] static void *allocate()
+    {
+        auto &cache = threadCache();
+        if (cache.head == nullptr)
+        {
+            refill(cache);
+        }
+
+        FreeBlock *block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+
+    // Returns storage obtained from allocate() to the calling thread's cache
+    static void deallocate(void *pointer) noexcept
+    {
+        auto *block = static_cast<FreeBlock *>(pointer);
+
+        // Other thread-local objects, such as the retired lists of the hazard pointer domain, may free nodes while
+        // the thread exits after its cache has already been destroyed
+        if (threadCacheDestroyed())
+        {
+            block->next = nullptr;
+            Depot &shared_depot = depot();
+            const std::lock_guard<std::mutex> lock{shared_depot.mutex};
+            shared_depot.push(block);
+            return;
+        }
+
+        auto &cache = threadCache();
+        block->next = cache.head;
+        cache.head = block;
+        ++cache.count;
+
+        if (cache.count >= THREAD_CACHE_LIMIT)
+        {
+            spill(cache);
+        }
+    }
+
+    // Preallocates at least count blocks into the shared depot, so that the first operations do not have to
+    // allocate either
+    static void reserve(std::size_t count)
+    {
+        Depot &shared_depot = depot();
+        for (std::size_t reserved = 0; reserved < count; reserved += BATCH_SIZE)
+        {
+            const Batch batch = allocateBatch();
+            const std::lock_guard<std::mutex> lock{shared_depot.mutex};
+            shared_depot.push(batch.head);
+        }
+    }
+
+    [[nodiscard]] static NodePoolStatistics statistics() noexcept
+    {
+        const Depot &shared_depot = depot();
+        return NodePoolStatistics{shared_depot.global_allocations.load(std::memory_order_relaxed),
+                                  shared_depot.refills.load(std::memory_order_relaxed),
+                                  shared_depot.spills.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+        // Set in the first block of a batch held by the depot: the first block of the next batch
+        FreeBlock *next_batch;
+    };
+
+    static constexpr std::size_t BLOCK_SIZE = std::max(sizeof(T), sizeof(FreeBlock));
+    static constexpr std::size_t BLOCK_ALIGNMENT = std::max(alignof(T), alignof(FreeBlock));
+
+    // Singly linked chain of free blocks
+    struct Batch
+    {
+        FreeBlock *head;
+        std::size_t count;
+    };
+
+    struct Depot
+    {
+        std::mutex mutex;
+        // Stack of batches, linked through their first blocks
+        FreeBlock *batches{nullptr};
+        std::atomic_size_t global_allocations{0U};
+        std::atomic_size_t refills{0U};
+        std::atomic_size_t spills{0U};
+
+        Depot() = default;
+        Depot(const Depot &other) = delete;
+        Depot &operator=(const Depot &other) = delete;
+
+        ~Depot()
+        {
+            while (batches != nullptr)
+            {
+                FreeBlock *block = pop();
+                while (block != nullptr)
+                {
+                    FreeBlock *next = block->next;
+                    ::operator delete(block, std::align_val_t{BLOCK_ALIGNMENT});
+                    block = next;
+                }
+            }
+        }
+
+        // Called with the mutex held
+        void push(FreeBlock *batch) noexcept
+        {
+            batch->next_batch = batches;
+            batches = batch;
+        }
+
+        // Called with the mutex held. Returns the first block of a batch, or nullptr if the depot is empty.
+        FreeBlock *pop() noexcept
+        {
+            FreeBlock *batch = batches;
+            if (batch != nullptr)
+            {
+                batches = batch->next_batch;
+            }
+            return batch;
+        }
+    };
+
+    struct ThreadCache
+    {
+        FreeBlock *head{nullptr};
+        std::size_t count{0U};
+
+        // Hands the cached blocks over to the depot when the thread exits
+        ~ThreadCache()
+        {
+            threadCacheDestroyed() = true;
+            if (count > 0U)
+            {
+                Depot &shared_depot = depot();
+                const std::lock_guard<std::mutex> lock{shared_depot.mutex};
+                shared_depot.push(head);
+            }
+        }
+    };
+
+    static Depot &depot() noexcept
+    {
+        static Depot shared_depot;
+        return shared_depot;
+    }
+
+    static ThreadCache &threadCache() noexcept
+    {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Trivially destructible, so it stays valid until the thread has exited
+    static bool &threadCacheDestroyed() noexcept
+    {
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    static Batch allocateBatch()
+    {
+        Batch batch{nullptr, 0U};
+        for (; batch.count < BATCH_SIZE; ++batch.count)
+        {
+            auto *block = static_cast<FreeBlock *>(::operator new(BLOCK_SIZE, std::align_val_t{BLOCK_ALIGNMENT}));
+            block->next = batch.head;
+            batch.head = block;
+        }
+        depot().global_allocations.fetch_add(batch.count, std::memory_order_relaxed);
+        return batch;
+    }
+
+    // Takes a batch from the depot, or from the global allocator if the depot is empty
+    static void refill(ThreadCache &cache)
+    {
+        Depot &shared_depot = depot();
+        Batch batch{nullptr, 0U};
+        {
+            const std::lock_guard<std::mutex> lock{shared_depot.mutex};
+            batch.head = shared_depot.pop();
+        }
+
+        if (batch.head == nullptr)
+        {
+            batch = allocateBatch();
+        }
+        else
+        {
+            // Batches vary in size, e.g. those left by exited threads; counted outside the lock
+            for (const FreeBlock *block = batch.head; block != nullptr; block = block->next)
+            {
+                ++batch.count;
+            }
+            shared_depot.refills.fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        cache.head = batch.head;
+        cache.count = batch.count;
+    }
+
+    // Moves BATCH_SIZE blocks from the cache to the depot
+    static void spill(ThreadCache &cache) noexcept
+    {
+        Batch batch{cache.head, BATCH_SIZE};
+        FreeBlock *last = cache.head;
+        for (std::size_t i = 1U; i < BATCH_SIZE; ++i)
+        {
+            last = last->next;
+        }
+        cache.head = last->next;
+        cache.count -= BATCH_SIZE;
+        last->next = nullptr;
+
+        Depot &shared_depot = depot();
+        {
+            const std::lock_guard<std::mutex> lock{shared_depot.mutex};
+            shared_depot.push(batch.head);
+        }
+        shared_depot.spills.fetch_add(1U, std::memory_order_relaxed);
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_NODE_POOL
@@ -0,0 +1,243 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_SHARDED_THREAD_SAFE_QUEUE
+#define COMMON_LIBRARY_CONCURRENCY_SHARDED_THREAD_SAFE_QUEUE
+
+#include <common_library/concurrency/cache_line.hpp>
+#include <common_library/concurrency/event_count.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace common_library::concurrency
+{
+// Unbounded queue split into shards, each a std::queue behind its own mutex, so that threads working on different
+// shards do not contend.
+//
+// Every thread has a home shard, assigned round-robin on its first use of a sharded queue of this value type. push()
+// appends to the home shard, or to the shard chosen by hashing a key, which keeps the values of one key in order.
+// pop() takes from the home shard first and steals from the following shards when it is empty, so values are spread
+// over the consumers but there is no global order between shards.
+//
+// Sleeping consumers wait on an EventCount. Only a push into an empty shard wakes a consumer; a consumer that wakes up
+// and finds more values wakes the next one. A burst of pushes thus costs one wake-up rather than one per push.
+//
+// close() and destruction behave like those of ThreadSafeQueue: after close() pushes are rejected and pop() returns
+// the remaining values, then an empty optional.
+template <typename T> class ShardedThreadSafeQueue final
+{
+  private:
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        std::mutex mutex;
+        std::queue<T> values;
+        // Number of values, read without the mutex to skip empty shards
+        std::atomic_size_t size{0U};
+    };
+
+    const std::size_t shard_count_;
+    const std::unique_ptr<Shard[]> shards_;
+
+    EventCount not_empty_;
+    std::atomic_bool closed_{false};
+    // Set by close() once no push can be in progress anymore, so that an empty queue stays empty
+    std::atomic_bool sealed_{false};
+    std::atomic_bool destructing_{false};
+
+    // Shard assigned to the calling thread
+    [[nodiscard]] std::size_t homeShard() const noexcept
+    {
+        static std::atomic_size_t next_thread_index{0U};
+        static thread_local const std::size_t thread_index =
+            next_thread_index.fetch_add(1U, std::memory_order_relaxed);
+        return thread_index % shard_count_;
+    }
+
+    bool pushTo(Shard &shard, T &&value)
+    {
+        bool was_empty;
+        {
+            const std::lock_guard<std::mutex> lock{shard.mutex};
+            if (closed_.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            was_empty = shard.values.empty();
+            shard.values.push(std::move(value));
+            shard.size.store(shard.values.size(), std::memory_order_release);
+        }
+        // Consumers sleep only after finding every shard empty, so a non-empty shard has been seen or announced
+        if (was_empty)
+        {
+            not_empty_.notifyOne();
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::optional<T> popFrom(Shard &shard)
+    {
+        if (shard.size.load(std::memory_order_acquire) == 0U)
+        {
+            return std::nullopt;
+        }
+
+        const std::lock_guard<std::mutex> lock{shard.mutex};
+        if (shard.values.empty())
+        {
+            return std::nullopt;
+        }
+        std::optional<T> value{std::move(shard.values.front())};
+        shard.values.pop();
+        shard.size.store(shard.values.size(), std::memory_order_release);
+        return value;
+    }
+
+  public:
+    // Uses one shard per hardware thread by default. Throws std::invalid_argument if shard_count is zero.
+    explicit ShardedThreadSafeQueue(std::size_t shard_count = std::max(std::thread::hardware_concurrency(), 1U))
+        : shard_count_(shard_count), shards_(new Shard[shard_count])
+    {
+        if (shard_count == 0U)
+        {
+            throw std::invalid_argument("ShardedThreadSafeQueue: shard_count must be positive");
+        }
+    }
+
+    ShardedThreadSafeQueue(const ShardedThreadSafeQueue &other) = delete;
+    ShardedThreadSafeQueue(ShardedThreadSafeQueue &&other) noexcept = delete;
+    ShardedThreadSafeQueue &operator=(const ShardedThreadSafeQueue &other) = delete;
+    ShardedThreadSafeQueue &operator=(ShardedThreadSafeQueue &&other) noexcept = delete;
+
+    ~ShardedThreadSafeQueue()
+    {
+        destructing_.store(true, std::memory_order_release);
+        not_empty_.notifyAll();
+    }
+
+    // Appends the value to the calling thread's home shard. Returns false if the queue is closed.
+    bool push(T value)
+    {
+        return pushTo(shards_[homeShard()], std::move(value));
+    }
+
+    // Appends the value to the shard of the key, so that values pushed with equal keys are popped in order when a
+    // single consumer pops them. Returns false if the queue is closed.
+    template <typename Key> bool push(const Key &key, T value)
+    {
+        return pushTo(shards_[std::hash<Key>{}(key) % shard_count_], std::move(value));
+    }
+
+    // Takes a value from the home shard, or steals one from the other shards. Returns an empty optional if every shard
+    // is empty.
+    [[nodiscard]] std::optional<T> tryPop()
+    {
+        const std::size_t home = homeShard();
+        for (std::size_t offset = 0U; offset < shard_count_; ++offset)
+        {
+            std::size_t index = home + offset;
+            if (index >= shard_count_)
+            {
+                index -= shard_count_;
+            }
+            if (std::optional<T> value = popFrom(shards_[index]))
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Waits for a value. Returns an empty optional if the queue is closed and empty, or being destroyed.
+    std::optional<T> pop()
+    {
+        bool woken = false;
+        for (;;)
+        {
+            if (std::optional<T> value = tryPop())
+            {
+                if (woken && !empty())
+                {
+                    // Pass the wake-up on for the values that arrived without one
+                    not_empty_.notifyOne();
+                }
+                return value;
+            }
+            if (destructing_.load(std::memory_order_acquire))
+            {
+                return std::nullopt;
+            }
+
+            const bool sealed = sealed_.load(std::memory_order_acquire);
+            const auto key = not_empty_.prepareWait();
+            if (std::optional<T> value = tryPop())
+            {
+                not_empty_.cancelWait();
+                return value;
+            }
+            if (sealed || destructing_.load(std::memory_order_acquire))
+            {
+                // Nothing can arrive anymore, and tryPop() found every shard empty after the seal
+                not_empty_.cancelWait();
+                return std::nullopt;
+            }
+            if (sealed_.load(std::memory_order_acquire))
+            {
+                // Sealed after the first check: look again before deciding
+                not_empty_.cancelWait();
+                continue;
+            }
+            not_empty_.wait(key);
+            woken = true;
+        }
+    }
+
+    // Rejects every push from now on; pop() still returns the values already queued
+    void close()
+    {
+        closed_.store(true, std::memory_order_relaxed);
+        // Pushes check the flag under their shard's mutex: once every mutex has been taken, none is in progress
+        for (std::size_t i = 0; i < shard_count_; ++i)
+        {
+            const std::lock_guard<std::mutex> lock{shards_[i].mutex};
+        }
+        sealed_.store(true, std::memory_order_release);
+        not_empty_.notifyAll();
+    }
+
+    [[nodiscard]] bool closed() const noexcept
+    {
+        return closed_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t shardCount() const noexcept
+    {
+        return shard_count_;
+    }
+
+    // The observers below are exact only when no other thread is pushing or popping at the same time.
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        std::size_t size = 0U;
+        for (std::size_t i = 0; i < shard_count_; ++i)
+        {
+            size += shards_[i].size.load(std::memory_order_acquire);
+        }
+        return size;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return (size() == 0U);
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_SHARDED_THREAD_SAFE_QUEUE
@@ -1,22 +1,89 @@
 #ifndef COMMON_LIBRARY_CONCURRENCY_SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
 #define COMMON_LIBRARY_CONCURRENCY_SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
 
+#include <common_library/concurrency/cache_line.hpp>
+
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
-#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace common_library::concurrency
 {
 // Single Producer Single Consumer Queue
-template <typename T> class SingleProducerSingleConsumerQueue final
+//
+// Elements live in raw aligned storage: a slot holds a constructed T only between the push and the pop of that
+// element, so construction and destruction costs are paid for live elements only, and move-only types are supported.
+//
+// When CacheAligned is set, the queue is laid out for two threads running on different cores:
+// - head_ and tail_ are placed on separate cache lines, so the producer and the consumer do not invalidate each
+//   other's line on every operation,
+// - the capacity is rounded up to a power of two, so wrapping an index is a mask instead of a modulo,
+// - the producer keeps a local copy of head_ and the consumer keeps a local copy of tail_, so the shared atomic
+//   written by the other side is only re-read when the queue looks full (producer) or empty (consumer).
+template <typename T, bool CacheAligned = false> class SingleProducerSingleConsumerQueue final
 {
+  public:
+    static constexpr auto CACHE_ALIGNED = CacheAligned;
+
+    // Contiguous run of slots inside the ring buffer, handed out by try_reserve() and peek()
+    struct SlotSpan
+    {
+        T *data;
+        std::size_t size;
+
+        [[nodiscard]] T *begin() const noexcept
+        {
+            return data;
+        }
+
+        [[nodiscard]] T *end() const noexcept
+        {
+            return data + size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return (size == 0U);
+        }
+
+        [[nodiscard]] T &operator[](std::size_t index) const noexcept
+        {
+            return data[index];
+        }
+    };
+
   private:
-    std::vector<T> buffer_;
-    std::atomic_size_t head_, tail_;
+    static constexpr std::size_t INDEX_ALIGNMENT = CACHE_ALIGNED ? CACHE_LINE_SIZE : alignof(std::atomic_size_t);
+
+    // Uninitialized storage for a single element
+    struct Slot
+    {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
     const std::size_t capacity_;
+    const std::size_t mask_;
+    const std::unique_ptr<Slot[]> buffer_;
+
+    // Written by the consumer, read by the producer
+    alignas(INDEX_ALIGNMENT) std::atomic_size_t head_;
+    // Consumer-local copy of tail_, only used when CACHE_ALIGNED is set
+    alignas(INDEX_ALIGNMENT) std::size_t tail_cache_;
+    // Written by the producer, read by the consumer
+    alignas(INDEX_ALIGNMENT) std::atomic_size_t tail_;
+    // Producer-local copy of head_, only used when CACHE_ALIGNED is set
+    alignas(INDEX_ALIGNMENT) std::size_t head_cache_;
+    // Producer-local number of slots past tail_ constructed by try_reserve() and not committed yet
+    std::size_t reserved_;
 
   public:
-    explicit SingleProducerSingleConsumerQueue(std::size_t size) : buffer_(size), head_(0), tail_(0), capacity_(size)
+    explicit SingleProducerSingleConsumerQueue(std::size_t size)
+        : capacity_(CACHE_ALIGNED ? roundUpToPowerOfTwo(size) : size), mask_(capacity_ - 1U),
+          buffer_(new Slot[capacity_]), head_(0), tail_cache_(0), tail_(0), head_cache_(0), reserved_(0)
     {
     }
 
@@ -24,37 +91,336 @@ template <typename T> class SingleProducerSingleConsumerQueue final
     SingleProducerSingleConsumerQueue(const SingleProducerSingleConsumerQueue &other) = delete;
     SingleProducerSingleConsumerQueue &operator=(const SingleProducerSingleConsumerQueue &other) = delete;
 
-    [[nodiscard]] bool push(const T &value) noexcept
+    // Destroys the elements still in the queue, including the slots reserved but not committed
+    ~SingleProducerSingleConsumerQueue()
+    {
+        const auto last = wrap(tail_.load(std::memory_order_acquire) + reserved_);
+        for (auto idx = head_.load(std::memory_order_relaxed); idx != last; idx = increment(idx))
+        {
+            std::destroy_at(slot(idx));
+        }
+    }
+
+    // Constructs an element in place from the arguments. Returns false if the queue is full.
+    template <typename... Args>
+    [[nodiscard]] bool emplace(Args &&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
     {
         const auto current_tail = tail_.load(std::memory_order_relaxed);
         const auto next_tail = increment(current_tail);
-        if (next_tail != head_.load(std::memory_order_acquire))
+        if (isFull(next_tail))
         {
-            buffer_[current_tail] = value;
-            tail_.store(next_tail, std::memory_order_release);
-            return true;
+            return false;
         }
-        return false;
+        abandonReservation(current_tail);
+        ::new (static_cast<void *>(storage(current_tail))) T(std::forward<Args>(args)...);
+        tail_.store(next_tail, std::memory_order_release);
+        return true;
     }
 
-    [[nodiscard]] bool pop(T &value) noexcept
+    [[nodiscard]] bool push(const T &value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        return emplace(value);
+    }
+
+    [[nodiscard]] bool push(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return emplace(std::move(value));
+    }
+
+    // Moves the oldest element out of the queue and destroys it in the slot. Returns false if the queue is empty.
+    [[nodiscard]] bool pop(T &value) noexcept(std::is_nothrow_move_assignable_v<T>)
     {
         const auto current_head = head_.load(std::memory_order_relaxed);
-        if (current_head == tail_.load(std::memory_order_acquire))
+        if (isEmpty(current_head))
         {
             return false;
         }
-        value = buffer_[current_head];
+        T *element = slot(current_head);
+        value = std::move(*element);
+        std::destroy_at(element);
         head_.store(increment(current_head), std::memory_order_release);
         return true;
     }
 
+    // Pushes all count values, or none of them if there is not enough free space or a copy throws.
+    // The values are copied in at most two contiguous segments and published with a single store to tail_.
+    [[nodiscard]] bool push_bulk(const T *values, std::size_t count) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        const auto current_tail = tail_.load(std::memory_order_relaxed);
+        if (freeSlots(current_tail, count) < count)
+        {
+            return false;
+        }
+        copyIn(current_tail, values, count);
+        return true;
+    }
+
+    // Pushes as many of the count values as there is free space for.
+    // Returns the number of values pushed, which is zero if the queue is full.
+    [[nodiscard]] std::size_t push_up_to(const T *values,
+                                         std::size_t count) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        const auto current_tail = tail_.load(std::memory_order_relaxed);
+        count = std::min(count, freeSlots(current_tail, count));
+        if (count > 0U)
+        {
+            copyIn(current_tail, values, count);
+        }
+        return count;
+    }
+
+    // Pops exactly count values, or none of them if fewer values are available.
+    // The values are moved out in at most two contiguous segments and released with a single store to head_.
+    [[nodiscard]] bool pop_bulk(T *values, std::size_t count) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        const auto current_head = head_.load(std::memory_order_relaxed);
+        if (usedSlots(current_head, count) < count)
+        {
+            return false;
+        }
+        moveOut(current_head, values, count);
+        return true;
+    }
+
+    // Pops up to count values. Returns the number of values popped, which is zero if the queue is empty.
+    [[nodiscard]] std::size_t pop_up_to(T *values, std::size_t count) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        const auto current_head = head_.load(std::memory_order_relaxed);
+        count = std::min(count, usedSlots(current_head, count));
+        if (count > 0U)
+        {
+            moveOut(current_head, values, count);
+        }
+        return count;
+    }
+
+    // Producer side of the zero-copy API. Returns the next free slot, holding a default-initialized element to be
+    // filled in place, or nullptr if the queue is full. The slot becomes visible to the consumer only after commit().
+    // Slots reserved again before being committed are handed out as they were left; a push abandons them.
+    [[nodiscard]] T *try_reserve() noexcept(std::is_nothrow_default_constructible_v<T>)
+    {
+        const auto span = try_reserve(1U);
+        return span.empty() ? nullptr : span.data;
+    }
+
+    // Returns up to count contiguous free slots, holding default-initialized elements to be filled in place. Fewer
+    // slots are returned if the queue does not have enough free space or if the run would wrap around the end of the
+    // ring buffer; the span is empty, with a null data pointer, if the queue is full.
+    [[nodiscard]] SlotSpan try_reserve(std::size_t count) noexcept(std::is_nothrow_default_constructible_v<T>)
+    {
+        const auto current_tail = tail_.load(std::memory_order_relaxed);
+        count = std::min({count, freeSlots(current_tail, count), capacity_ - current_tail});
+        if (count == 0U)
+        {
+            // The slot may hold no element, so its storage must not be laundered into a T
+            return SlotSpan{nullptr, 0U};
+        }
+        T *first = storage(current_tail);
+        for (; reserved_ < count; ++reserved_)
+        {
+            ::new (static_cast<void *>(first + reserved_)) T;
+        }
+        return SlotSpan{std::launder(first), count};
+    }
+
+    // Publishes the first count reserved slots to the consumer. Must not exceed the number of slots reserved.
+    void commit(std::size_t count = 1U) noexcept
+    {
+        reserved_ -= count;
+        tail_.store(wrap(tail_.load(std::memory_order_relaxed) + count), std::memory_order_release);
+    }
+
+    // Consumer side of the zero-copy API. Returns the oldest element to be read in place, or nullptr if the queue is
+    // empty. The slot stays owned by the consumer until release().
+    [[nodiscard]] T *peek() noexcept
+    {
+        const auto current_head = head_.load(std::memory_order_relaxed);
+        if (isEmpty(current_head))
+        {
+            return nullptr;
+        }
+        return slot(current_head);
+    }
+
+    // Returns up to count contiguous elements to be read in place. Fewer elements are returned if the queue holds
+    // fewer or if the run would wrap around the end of the ring buffer; the span is empty if the queue is empty.
+    [[nodiscard]] SlotSpan peek(std::size_t count) noexcept
+    {
+        const auto current_head = head_.load(std::memory_order_relaxed);
+        count = std::min({count, usedSlots(current_head, count), capacity_ - current_head});
+        return SlotSpan{(count > 0U) ? slot(current_head) : storage(current_head), count};
+    }
+
+    // Destroys the first count peeked elements and hands their slots back to the producer. Must not exceed the number
+    // of elements peeked.
+    void release(std::size_t count = 1U) noexcept
+    {
+        const auto current_head = head_.load(std::memory_order_relaxed);
+        std::destroy_n(slot(current_head), count);
+        head_.store(wrap(current_head + count), std::memory_order_release);
+    }
+
+    // Number of slots in the ring buffer. One slot is always kept free to distinguish a full queue from an empty one.
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
   private:
+    // Pointer to the storage of a slot, used to construct an element in it
+    [[nodiscard]] T *storage(std::size_t idx) const noexcept
+    {
+        return reinterpret_cast<T *>(&buffer_[idx]);
+    }
+
+    // Pointer to the live element held by a slot
+    [[nodiscard]] T *slot(std::size_t idx) const noexcept
+    {
+        return std::launder(storage(idx));
+    }
+
+    // Wraps an index in the range [0, 2 * capacity_) back into the ring buffer
+    [[nodiscard]] std::size_t wrap(std::size_t idx) const noexcept
+    {
+        if constexpr (CACHE_ALIGNED)
+        {
+            return idx & mask_;
+        }
+        else
+        {
+            return idx % capacity_;
+        }
+    }
+
     [[nodiscard]] std::size_t increment(std::size_t idx) const noexcept
     {
-        return (idx + 1) % capacity_;
+        return wrap(idx + 1);
+    }
+
+    // Called by the producer only. Returns the number of free slots, re-reading head_ in the cache aligned mode only
+    // if the cached copy does not leave room for the required number of slots.
+    [[nodiscard]] std::size_t freeSlots(std::size_t current_tail, std::size_t required) noexcept
+    {
+        if constexpr (CACHE_ALIGNED)
+        {
+            const auto free_slots = wrap(head_cache_ + capacity_ - current_tail - 1U);
+            if (free_slots >= required)
+            {
+                return free_slots;
+            }
+            head_cache_ = head_.load(std::memory_order_acquire);
+            return wrap(head_cache_ + capacity_ - current_tail - 1U);
+        }
+        else
+        {
+            return wrap(head_.load(std::memory_order_acquire) + capacity_ - current_tail - 1U);
+        }
+    }
+
+    // Called by the consumer only. Returns the number of occupied slots, re-reading tail_ in the cache aligned mode
+    // only if the cached copy does not hold the required number of slots.
+    [[nodiscard]] std::size_t usedSlots(std::size_t current_head, std::size_t required) noexcept
+    {
+        if constexpr (CACHE_ALIGNED)
+        {
+            const auto used_slots = wrap(tail_cache_ + capacity_ - current_head);
+            if (used_slots >= required)
+            {
+                return used_slots;
+            }
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            return wrap(tail_cache_ + capacity_ - current_head);
+        }
+        else
+        {
+            return wrap(tail_.load(std::memory_order_acquire) + capacity_ - current_head);
+        }
+    }
+
+    // Destroys the elements left in the slots by a try_reserve() that was not committed
+    void abandonReservation(std::size_t current_tail) noexcept
+    {
+        if (reserved_ != 0U)
+        {
+            std::destroy_n(slot(current_tail), reserved_);
+            reserved_ = 0U;
+        }
+    }
+
+    // Copy-constructs count values into the free slots starting at current_tail and publishes them. If a copy throws,
+    // the elements already constructed are destroyed and nothing is published.
+    void copyIn(std::size_t current_tail, const T *values, std::size_t count)
+    {
+        abandonReservation(current_tail);
+
+        const auto first_segment = std::min(count, capacity_ - current_tail);
+        std::uninitialized_copy(values, values + first_segment, storage(current_tail));
+        try
+        {
+            std::uninitialized_copy(values + first_segment, values + count, storage(0U));
+        }
+        catch (...)
+        {
+            std::destroy_n(slot(current_tail), first_segment);
+            throw;
+        }
+        tail_.store(wrap(current_tail + count), std::memory_order_release);
+    }
+
+    // Moves count values out of the occupied slots starting at current_head, destroys them and releases the slots
+    void moveOut(std::size_t current_head, T *values, std::size_t count)
+    {
+        const auto first_segment = std::min(count, capacity_ - current_head);
+        T *first = slot(current_head);
+        std::move(first, first + first_segment, values);
+        std::destroy_n(first, first_segment);
+
+        if (count > first_segment)
+        {
+            T *second = slot(0U);
+            std::move(second, second + (count - first_segment), values + first_segment);
+            std::destroy_n(second, count - first_segment);
+        }
+
+        head_.store(wrap(current_head + count), std::memory_order_release);
+    }
+
+    // Called by the producer only
+    [[nodiscard]] bool isFull(std::size_t next_tail) noexcept
+    {
+        if constexpr (CACHE_ALIGNED)
+        {
+            if (next_tail != head_cache_)
+            {
+                return false;
+            }
+            head_cache_ = head_.load(std::memory_order_acquire);
+            return (next_tail == head_cache_);
+        }
+        else
+        {
+            return (next_tail == head_.load(std::memory_order_acquire));
+        }
+    }
+
+    // Called by the consumer only
+    [[nodiscard]] bool isEmpty(std::size_t current_head) noexcept
+    {
+        if constexpr (CACHE_ALIGNED)
+        {
+            if (current_head != tail_cache_)
+            {
+                return false;
+            }
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            return (current_head == tail_cache_);
+        }
+        else
+        {
+            return (current_head == tail_.load(std::memory_order_acquire));
+        }
     }
 };
 } // namespace common_library::concurrency
 
-#endif // COMMON_LIBRARY_CONCURRENCY_SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
\ No newline at end of file
+#endif // COMMON_LIBRARY_CONCURRENCY_SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
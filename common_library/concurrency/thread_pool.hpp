@@ -0,0 +1,691 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_THREAD_POOL
+#define COMMON_LIBRARY_CONCURRENCY_THREAD_POOL
+
+#include <common_library/concurrency/cache_line.hpp>
+#include <common_library/concurrency/event_count.hpp>
+#include <common_library/concurrency/lock_free_queue.hpp>
+#include <common_library/concurrency/work_stealing_deque.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace common_library::concurrency
+{
+class ThreadPool;
+
+// State shared by a task submitted to a ThreadPool and its TaskFuture, released by whichever of the two finishes last
+class TaskState
+{
+  public:
+    TaskState() = default;
+    TaskState(const TaskState &other) = delete;
+    TaskState(TaskState &&other) noexcept = delete;
+    TaskState &operator=(const TaskState &other) = delete;
+    TaskState &operator=(TaskState &&other) noexcept = delete;
+
+    virtual ~TaskState() = default;
+
+    [[nodiscard]] bool ready() const noexcept
+    {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    // Blocks until the task has finished
+    void wait() noexcept
+    {
+        while (!ready())
+        {
+            const auto key = completed_.prepareWait();
+            if (ready())
+            {
+                completed_.cancelWait();
+                break;
+            }
+            completed_.wait(key);
+        }
+    }
+
+    void release() noexcept
+    {
+        if (references_.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+        {
+            delete this;
+        }
+    }
+
+  protected:
+    std::exception_ptr error_;
+
+    void finish() noexcept
+    {
+        ready_.store(true, std::memory_order_release);
+        completed_.notifyAll();
+    }
+
+  private:
+    std::atomic_bool ready_{false};
+    EventCount completed_;
+    // One reference for the task, one for the future
+    std::atomic<std::uint32_t> references_{2U};
+};
+
+// Result of a submitted task; the void specialization holds only the exception
+template <typename R> class TaskResult : public TaskState
+{
+  public:
+    [[nodiscard]] R take()
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+  protected:
+    std::optional<R> value_;
+};
+
+template <> class TaskResult<void> : public TaskState
+{
+  public:
+    void take()
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+    }
+};
+
+// Handle to the result of a task submitted with ThreadPool::submit(). Unlike std::future it needs a single allocation,
+// shared with the task, and no mutex.
+//
+// Waiting from a worker thread of the pool that runs the task does not block the worker: it runs other tasks of the
+// pool until the result is ready, so tasks may wait for the tasks they submit. Destroying a future without waiting
+// detaches it from the task, which still runs. A future stays usable after its pool has been destroyed, which runs
+// every queued task first.
+template <typename R> class TaskFuture final
+{
+  public:
+    TaskFuture() noexcept = default;
+
+    TaskFuture(const TaskFuture &other) = delete;
+    TaskFuture &operator=(const TaskFuture &other) = delete;
+
+    TaskFuture(TaskFuture &&other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), pool_(std::exchange(other.pool_, nullptr))
+    {
+    }
+
+    TaskFuture &operator=(TaskFuture &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            state_ = std::exchange(other.state_, nullptr);
+            pool_ = std::exchange(other.pool_, nullptr);
+        }
+        return *this;
+    }
+
+    ~TaskFuture()
+    {
+        reset();
+    }
+
+    // False for a default-constructed or moved-from future, and after get()
+    [[nodiscard]] bool valid() const noexcept
+    {
+        return (state_ != nullptr);
+    }
+
+    // True once the task has finished. The future must be valid.
+    [[nodiscard]] bool ready() const noexcept
+    {
+        return state_->ready();
+    }
+
+    // Blocks until the task has finished. The future must be valid.
+    void wait();
+
+    // Waits for the task and returns its result, or rethrows the exception it threw. The future must be valid and is
+    // no longer valid afterwards.
+    R get()
+    {
+        wait();
+        TaskResult<R> *state = std::exchange(state_, nullptr);
+        pool_ = nullptr;
+        // Release the state even if the result is an exception
+        const std::unique_ptr<TaskResult<R>, void (*)(TaskResult<R> *)> guard{
+            state, [](TaskResult<R> *released) { released->release(); }};
+        return state->take();
+    }
+
+  private:
+    friend class ThreadPool;
+
+    TaskResult<R> *state_{nullptr};
+    ThreadPool *pool_{nullptr};
+
+    TaskFuture(TaskResult<R> *state, ThreadPool *pool) noexcept : state_(state), pool_(pool)
+    {
+    }
+
+    void reset() noexcept
+    {
+        if (state_ != nullptr)
+        {
+            state_->release();
+            state_ = nullptr;
+            pool_ = nullptr;
+        }
+    }
+};
+
+// Fixed-size pool of worker threads with work stealing.
+//
+// Every worker owns a Chase-Lev deque (WorkStealingDeque). Tasks submitted by a worker go to the bottom of its own
+// deque, and the worker takes them back from there in LIFO order, while their data is still in its cache. Tasks
+// submitted by other threads go to a shared LockFreeQueue. A worker whose deque is empty takes from the shared queue,
+// then steals from the top of the other workers' deques, starting at a random victim so that thieves spread out.
+//
+// Idle workers search for a while, then sleep on an EventCount. A submission wakes a worker only when none is
+// searching, so a burst of submissions to a busy pool costs no system call.
+//
+// The destructor runs all queued tasks, then joins the workers. Submitting from another thread while the pool is
+// being destroyed is undefined.
+class ThreadPool final
+{
+  private:
+    // Type-erased unit of work. execute() runs it and releases it.
+    class Task
+    {
+      public:
+        Task() = default;
+        Task(const Task &other) = delete;
+        Task(Task &&other) noexcept = delete;
+        Task &operator=(const Task &other) = delete;
+        Task &operator=(Task &&other) noexcept = delete;
+
+        virtual ~Task() = default;
+
+        virtual void execute() noexcept = 0;
+    };
+
+    // Task of submit(), holding its result until both the task and the future are done with it
+    template <typename R, typename Function> class SubmittedTask final : public Task, public TaskResult<R>
+    {
+      public:
+        explicit SubmittedTask(Function &&function) : function_(std::move(function))
+        {
+        }
+
+        void execute() noexcept override
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    function_();
+                }
+                else
+                {
+                    this->value_.emplace(function_());
+                }
+            }
+            catch (...)
+            {
+                this->error_ = std::current_exception();
+            }
+            this->finish();
+            this->release();
+        }
+
+      private:
+        Function function_;
+    };
+
+    // State of one parallelFor() call, shared by the tasks running parts of its range
+    template <typename Index, typename Body> class ParallelLoop final
+    {
+      public:
+        ParallelLoop(ThreadPool &pool, const Body &body, Index grain) : pool_(pool), body_(body), grain_(grain)
+        {
+        }
+
+        // Runs the body over [first, last). Halves the range while it is larger than the grain, submitting the upper
+        // halves so that idle workers can steal them.
+        void run(const std::shared_ptr<ParallelLoop> &self, Index first, Index last) noexcept
+        {
+            while (last - first > grain_)
+            {
+                const Index middle = first + (last - first) / 2;
+                pending_.fetch_add(1U, std::memory_order_relaxed);
+                try
+                {
+                    pool_.schedule(new RangeTask(self, middle, last));
+                }
+                catch (...)
+                {
+                    pending_.fetch_sub(1U, std::memory_order_relaxed);
+                    fail(std::current_exception());
+                    break;
+                }
+                last = middle;
+            }
+
+            for (Index index = first; index < last; ++index)
+            {
+                if (failed_.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                try
+                {
+                    body_(index);
+                }
+                catch (...)
+                {
+                    fail(std::current_exception());
+                    return;
+                }
+            }
+        }
+
+        void finishTask() noexcept
+        {
+            if (pending_.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+            {
+                completed_.notifyAll();
+            }
+        }
+
+        [[nodiscard]] bool done() const noexcept
+        {
+            return (pending_.load(std::memory_order_acquire) == 0U);
+        }
+
+        void wait() noexcept
+        {
+            while (!done())
+            {
+                const auto key = completed_.prepareWait();
+                if (done())
+                {
+                    completed_.cancelWait();
+                    break;
+                }
+                completed_.wait(key);
+            }
+        }
+
+        void rethrowIfFailed()
+        {
+            if (failed_.load(std::memory_order_acquire))
+            {
+                std::rethrow_exception(error_);
+            }
+        }
+
+      private:
+        class RangeTask final : public Task
+        {
+          public:
+            RangeTask(std::shared_ptr<ParallelLoop> loop, Index first, Index last)
+                : loop_(std::move(loop)), first_(first), last_(last)
+            {
+            }
+
+            void execute() noexcept override
+            {
+                loop_->run(loop_, first_, last_);
+                // The loop must outlive finishTask(), whose caller may return as soon as pending_ drops to zero
+                const std::shared_ptr<ParallelLoop> loop = std::move(loop_);
+                delete this;
+                loop->finishTask();
+            }
+
+          private:
+            std::shared_ptr<ParallelLoop> loop_;
+            const Index first_;
+            const Index last_;
+        };
+
+        ThreadPool &pool_;
+        const Body &body_;
+        const Index grain_;
+        // Submitted parts not finished yet
+        std::atomic_size_t pending_{0U};
+        EventCount completed_;
+        // First exception thrown by the body; the remaining indices are skipped once it is set
+        std::atomic_bool failed_{false};
+        std::atomic_bool failing_{false};
+        std::exception_ptr error_;
+
+        void fail(std::exception_ptr error) noexcept
+        {
+            if (!failing_.exchange(true, std::memory_order_relaxed))
+            {
+                error_ = std::move(error);
+                failed_.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker
+    {
+        WorkStealingDeque<Task *> deque;
+        // State of the victim selection, used by the worker's own thread only
+        std::uint32_t random_state;
+        std::thread thread;
+    };
+
+    // Pool and worker index of the calling thread, set on worker threads only
+    struct WorkerContext
+    {
+        ThreadPool *pool{nullptr};
+        std::size_t index{0U};
+    };
+
+    // Number of search rounds an idle worker goes through before sleeping
+    static constexpr int SEARCH_ROUNDS = 64;
+
+    const std::size_t thread_count_;
+    std::unique_ptr<Worker[]> workers_;
+    LockFreeQueue<Task *> injection_queue_;
+
+    EventCount work_available_;
+    // Number of workers looking for a task without sleeping
+    std::atomic_size_t searching_{0U};
+    std::atomic_bool stopping_{false};
+
+    [[nodiscard]] static WorkerContext &workerContext() noexcept
+    {
+        static thread_local WorkerContext context;
+        return context;
+    }
+
+    // Index of the calling thread among the pool's workers, or thread_count_ for any other thread
+    [[nodiscard]] std::size_t currentWorker() const noexcept
+    {
+        const WorkerContext &context = workerContext();
+        return (context.pool == this) ? context.index : thread_count_;
+    }
+
+    // Queues a task and wakes a worker if none is searching
+    void schedule(Task *task)
+    {
+        const std::size_t worker = currentWorker();
+        if (worker < thread_count_)
+        {
+            workers_[worker].deque.push(task);
+        }
+        else
+        {
+            injection_queue_.push(task);
+        }
+
+        // Pairs with the update of searching_ by a worker about to sleep: either it sees the task when it looks again,
+        // or this thread sees that nobody searches and wakes a sleeping worker
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (searching_.load(std::memory_order_relaxed) == 0U)
+        {
+            work_available_.notifyOne();
+        }
+    }
+
+    // Takes a task from the shared queue or steals one from a random worker. worker is the index of the calling
+    // worker, or thread_count_ for any other thread.
+    [[nodiscard]] Task *findForeignTask(std::size_t worker) noexcept
+    {
+        Task *task = nullptr;
+        if (injection_queue_.try_pop(task))
+        {
+            return task;
+        }
+
+        std::size_t victim = worker;
+        if (worker < thread_count_)
+        {
+            // xorshift32
+            std::uint32_t &state = workers_[worker].random_state;
+            state ^= state << 13U;
+            state ^= state >> 17U;
+            state ^= state << 5U;
+            victim = state % thread_count_;
+        }
+        for (std::size_t attempt = 0U; attempt < thread_count_; ++attempt)
+        {
+            victim = (victim + 1U < thread_count_) ? victim + 1U : 0U;
+            if ((victim != worker) && workers_[victim].deque.steal(task))
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] Task *findTask(std::size_t worker) noexcept
+    {
+        Task *task = nullptr;
+        if ((worker < thread_count_) && workers_[worker].deque.pop(task))
+        {
+            return task;
+        }
+        return findForeignTask(worker);
+    }
+
+    void workerLoop(std::size_t worker) noexcept
+    {
+        workerContext() = WorkerContext{this, worker};
+
+        for (;;)
+        {
+            Task *task = nullptr;
+            if (workers_[worker].deque.pop(task))
+            {
+                task->execute();
+                continue;
+            }
+
+            searching_.fetch_add(1U, std::memory_order_seq_cst);
+            for (int round = 0; (round < SEARCH_ROUNDS) && (task == nullptr); ++round)
+            {
+                task = findForeignTask(worker);
+                if ((task == nullptr) && (round > 0))
+                {
+                    std::this_thread::yield();
+                }
+            }
+            if ((searching_.fetch_sub(1U, std::memory_order_seq_cst) == 1U) && (task != nullptr))
+            {
+                // The last searcher found work: there may be more, submitted without a wake-up while it searched
+                work_available_.notifyOne();
+            }
+            if (task != nullptr)
+            {
+                task->execute();
+                continue;
+            }
+
+            const auto key = work_available_.prepareWait();
+            task = findTask(worker);
+            if (task != nullptr)
+            {
+                work_available_.cancelWait();
+                task->execute();
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire))
+            {
+                // Every queue was empty after the stop request was seen
+                work_available_.cancelWait();
+                return;
+            }
+            work_available_.wait(key);
+        }
+    }
+
+    // Runs tasks of the pool on the calling thread until done() returns true. Returns false without waiting if the
+    // calling thread is not a worker of the pool.
+    template <typename Done> bool helpUntil(const Done &done) noexcept
+    {
+        const std::size_t worker = currentWorker();
+        if (worker == thread_count_)
+        {
+            return false;
+        }
+        while (!done())
+        {
+            if (Task *task = findTask(worker))
+            {
+                task->execute();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    template <typename R> friend class TaskFuture;
+
+  public:
+    // Starts one worker per hardware thread by default. Throws std::invalid_argument if thread_count is zero.
+    explicit ThreadPool(std::size_t thread_count = std::max(std::thread::hardware_concurrency(), 1U))
+        : thread_count_(thread_count), workers_(new Worker[thread_count])
+    {
+        if (thread_count == 0U)
+        {
+            throw std::invalid_argument("ThreadPool: thread_count must be positive");
+        }
+
+        try
+        {
+            for (std::size_t i = 0; i < thread_count_; ++i)
+            {
+                // xorshift32 needs a non-zero state
+                workers_[i].random_state = static_cast<std::uint32_t>(i) * 2654435761U + 1U;
+                workers_[i].thread = std::thread(&ThreadPool::workerLoop, this, i);
+            }
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool(ThreadPool &&other) noexcept = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+    ThreadPool &operator=(ThreadPool &&other) noexcept = delete;
+
+    ~ThreadPool()
+    {
+        stop();
+    }
+
+    // Queues the function, which is called without arguments on a worker thread, and returns a future for its result.
+    // Exceptions thrown by the function are rethrown by TaskFuture::get().
+    template <typename Function> auto submit(Function &&function)
+    {
+        using Callable = std::decay_t<Function>;
+        using Result = std::invoke_result_t<Callable &>;
+        static_assert(!std::is_reference_v<Result>, "ThreadPool::submit: the function must return by value");
+
+        auto *task = new SubmittedTask<Result, Callable>(Callable(std::forward<Function>(function)));
+        try
+        {
+            schedule(task);
+        }
+        catch (...)
+        {
+            delete task;
+            throw;
+        }
+        return TaskFuture<Result>{task, this};
+    }
+
+    // Calls body(index) for every index in [first, last) on the workers and the calling thread, and returns when all
+    // calls have returned. The range is split recursively down to parts of grain indices; a grain of zero picks one
+    // that gives every worker several parts to balance the load. If the body throws, the remaining indices may be
+    // skipped and the first exception is rethrown.
+    template <typename Index, typename Body>
+    void parallelFor(Index first, Index last, const Body &body, Index grain = Index{0})
+    {
+        static_assert(std::is_integral_v<Index>, "ThreadPool::parallelFor: Index must be an integral type");
+        if (first >= last)
+        {
+            return;
+        }
+        if (grain <= Index{0})
+        {
+            // Computed in std::size_t: the number of parts may not fit a narrow Index, nor the length a signed one
+            using Unsigned = std::make_unsigned_t<Index>;
+            const auto length = static_cast<std::size_t>(static_cast<Unsigned>(last) - static_cast<Unsigned>(first));
+            const std::size_t parts = std::min<std::size_t>(thread_count_ * 8U, 1U << 20U);
+            const auto max_grain = static_cast<std::size_t>(std::numeric_limits<Index>::max());
+            grain = static_cast<Index>(std::max<std::size_t>(std::min(length / parts, max_grain), 1U));
+        }
+
+        auto loop = std::make_shared<ParallelLoop<Index, Body>>(*this, body, grain);
+        loop->run(loop, first, last);
+        if (!helpUntil([&loop]() { return loop->done(); }))
+        {
+            loop->wait();
+        }
+        loop->rethrowIfFailed();
+    }
+
+    [[nodiscard]] std::size_t threadCount() const noexcept
+    {
+        return thread_count_;
+    }
+
+  private:
+    void stop() noexcept
+    {
+        stopping_.store(true, std::memory_order_release);
+        work_available_.notifyAll();
+        for (std::size_t i = 0; i < thread_count_; ++i)
+        {
+            if (workers_[i].thread.joinable())
+            {
+                workers_[i].thread.join();
+            }
+        }
+    }
+};
+
+template <typename R> void TaskFuture<R>::wait()
+{
+    TaskResult<R> *state = state_;
+    if (state->ready())
+    {
+        return;
+    }
+    // Only a worker of the pool may help it, and the pool is certainly alive then. Any other thread must not touch
+    // pool_: the pool may have been destroyed after running the task.
+    if (ThreadPool::workerContext().pool == pool_)
+    {
+        pool_->helpUntil([state]() { return state->ready(); });
+        return;
+    }
+    state->wait();
+}
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_THREAD_POOL
@@ -1,28 +1,161 @@
 #ifndef COMMON_LIBRARY_CONCURRENCY_THREAD_SAFE_LOGGER
 #define COMMON_LIBRARY_CONCURRENCY_THREAD_SAFE_LOGGER
 
+#include <common_library/concurrency/cycle_clock.hpp>
+#include <common_library/concurrency/event_count.hpp>
+#include <common_library/concurrency/log_record.hpp>
+#include <common_library/concurrency/log_sink.hpp>
+#include <common_library/concurrency/multi_producer_multi_consumer_queue.hpp>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
-#include <iostream>
+#include <functional>
+#include <memory>
+#include <exception>
 #include <mutex>
-#include <queue>
 #include <sstream>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
+
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 
 namespace common_library::concurrency
 {
+// What log() does when the calling thread's buffer is full
+enum class LogOverflowPolicy : std::uint8_t
+{
+    // Discard the new message
+    DROP_NEWEST,
+    // Discard the oldest message of the buffer to make room for the new one
+    DROP_OLDEST,
+    // Wait for the worker to make room, up to the block timeout, then discard the new message
+    BLOCK,
+    // Once the buffer is half full, keep only one in every sample rate messages; discard the new message when full
+    SAMPLE
+};
+
+// Asynchronous logger.
+//
+// log() does not format anything and does not take a lock: it serializes its arguments (see LogSerializer) and a
+// timestamp into a fixed-size record of a ring buffer owned by the calling thread. A worker thread collects the records
+// into batches and hands every batch to each LogSink: the standard output by default, or files, an in-memory ring, a
+// UDP port or binary log files (see log_sink.hpp). Wrap a slow sink into an AsyncLogSink so that it gets its own
+// thread. A message that does not fit into a record is formatted by the caller into a heap allocated string.
+//
+// Messages logged by one thread are written in order; messages of different threads may be interleaved.
+//
+// Loggers are independent of each other, e.g. one per subsystem with its own sinks and level; getInstance() returns
+// a process-wide logger.
+//
+// Every message has a LogLevel. Messages below the runtime threshold (setLevel()) are discarded before they are
+// serialized. The COMMON_LIBRARY_LOG_* macros check the threshold before evaluating their arguments, and compile to
+// nothing for levels below COMMON_LIBRARY_LOG_MIN_LEVEL:
+//     COMMON_LIBRARY_LOG_DEBUG(logger, "Queue size: ", queue.size()); // queue.size() is not called if DEBUG is off
+//
+// When a thread logs faster than the worker writes, its buffer fills up and the LogOverflowPolicy decides which
+// messages are discarded. Discarded messages are counted per thread without synchronization, and the worker reports
+// them in a single WARNING line per drop report interval instead of one line per message. Writes that a sink failed
+// by throwing are reported in the same interval, as one ERROR line.
 class ThreadSafeLogger final
 {
   private:
-    std::queue<std::string> queue_;
-    std::mutex mutex_;
-    std::condition_variable condition_;
+    static constexpr std::size_t DRAIN_BATCH_SIZE = 64U;
+    static constexpr int DROP_OLDEST_ATTEMPTS = 4;
+    // Records collected before the batch is handed to the sinks
+    static constexpr std::size_t SINK_BATCH_SIZE = 1024U;
+    static constexpr std::chrono::milliseconds DEFAULT_BLOCK_TIMEOUT{10};
+    static constexpr std::chrono::seconds DEFAULT_DROP_REPORT_INTERVAL{1};
+    static constexpr std::uint32_t DEFAULT_SAMPLE_RATE = 10U;
+
+    // Records logged by one thread. The thread is the only producer and the worker the only consumer, except with
+    // LogOverflowPolicy::DROP_OLDEST, where the thread also pops the oldest record when the buffer is full.
+    struct ThreadBuffer
+    {
+        MultiProducerMultiConsumerQueue<LogRecord> records;
+        // Operating system id of the owning thread, written to binary logs
+        const std::uint32_t thread_id;
+        // Messages discarded by the owning thread, which is the only writer
+        std::atomic_uint64_t dropped{0U};
+        // Part of dropped already reported by the worker, which is the only user
+        std::uint64_t dropped_reported{0U};
+        // Messages seen by the owning thread while sampling
+        std::uint32_t sample_counter{0U};
+        // Set when the owning thread exits, so that the worker drops the buffer once it is drained
+        std::atomic_bool abandoned{false};
+        // Set when the logger is destroyed, so that the owning thread drops the buffer from its cache
+        std::atomic_bool orphaned{false};
+
+        ThreadBuffer(std::size_t capacity, std::uint32_t thread_id) : records(capacity), thread_id(thread_id)
+        {
+        }
+    };
+
+    // Buffers of the calling thread, one per logger the thread has logged to
+    struct ThreadBufferCache
+    {
+        std::vector<std::pair<std::uint64_t, std::shared_ptr<ThreadBuffer>>> entries;
+
+        ~ThreadBufferCache()
+        {
+            for (const auto &entry : entries)
+            {
+                entry.second->abandoned.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static inline std::atomic_uint64_t next_id_{1U};
+    static inline std::atomic_bool max_log_messages_set_{false};
+
+    const std::uint64_t id_;
+    const std::uint32_t max_log_messages_within_buffer_;
+
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::atomic_bool buffers_changed_{false};
+
+    // The worker sleeps on it while all buffers are empty
+    EventCount wake_;
+    std::atomic_bool exit_{false};
+
+    std::atomic<LogLevel> level_{LogLevel::INFO};
+
+    std::atomic<LogOverflowPolicy> overflow_policy_{LogOverflowPolicy::DROP_NEWEST};
+    std::atomic<std::chrono::nanoseconds> block_timeout_{DEFAULT_BLOCK_TIMEOUT};
+    std::atomic_uint32_t sample_rate_{DEFAULT_SAMPLE_RATE};
+    std::atomic<std::chrono::nanoseconds> drop_report_interval_{DEFAULT_DROP_REPORT_INTERVAL};
+    // Producers blocked by LogOverflowPolicy::BLOCK sleep on it until the worker frees records
+    EventCount space_;
+    // Messages dropped by threads that have exited, not reported yet; used by the worker only
+    std::uint64_t dropped_by_exited_threads_{0U};
+    // Messages dropped by threads whose buffers were released; read by droppedMessages()
+    std::atomic_uint64_t dropped_by_released_buffers_{0U};
+    // Sink writes that threw since the last report and the error of the last one; used by the worker only
+    std::uint64_t failed_sink_writes_{0U};
+    std::string last_sink_error_;
+
+    // flush() requests are numbered; the worker publishes the last one it completed
+    std::atomic_uint64_t flush_requested_{0U};
+    std::uint64_t flush_completed_{0U};
+    std::mutex flush_mutex_;
+    std::condition_variable flush_condition_;
+
+    // The worker holds the mutex while it writes to the sinks
+    std::mutex sinks_mutex_;
+    std::vector<std::shared_ptr<LogSink>> sinks_{std::make_shared<StandardOutputLogSink>()};
+
+    // Used by the worker only
+    LogBatch batch_;
+
     std::thread worker_;
-    std::atomic_bool exit_;
-    std::uint32_t max_log_messages_within_buffer_;
-    static std::atomic_bool max_log_messages_set_;
 
     static std::uint32_t &getMaxLogMessages()
     {
@@ -38,55 +171,413 @@ class ThreadSafeLogger final
         }
     }
 
-    // Private constructor to prevent instantiation
-    explicit ThreadSafeLogger(std::uint32_t max_log_messages_within_buffer)
-        : max_log_messages_within_buffer_(max_log_messages_within_buffer), exit_(false),
-          worker_(std::thread(&ThreadSafeLogger::processLogs, this))
+    template <typename... Values> void enqueue(LogLevel level, const Values &...values)
     {
+        ThreadBuffer &buffer = threadBuffer();
+        const LogOverflowPolicy policy = overflow_policy_.load(std::memory_order_relaxed);
+        if ((policy == LogOverflowPolicy::SAMPLE) && (2U * buffer.records.size() >= buffer.records.maxSize()) &&
+            ((++buffer.sample_counter % std::max(sample_rate_.load(std::memory_order_relaxed), 1U)) != 0U))
+        {
+            countDropped(buffer);
+            return;
+        }
+
+        LogRecord record;
+        record.timestamp = CycleClock::now();
+        record.level = level;
+        if (LogSerializer::encodedSize(values...) <= LogSerializer::PAYLOAD_SIZE)
+        {
+            record.format = LogSerializer::encode(record.payload, values...);
+        }
+        else
+        {
+            std::ostringstream stream;
+            (stream << ... << values);
+            record.format = LogSerializer::encodeOversized(record.payload, stream.str());
+        }
+
+        if (!push(buffer, record, policy))
+        {
+            destroyRecord(record);
+            countDropped(buffer);
+            return;
+        }
+        wake_.notifyOne();
+    }
+
+    // Pushes the record to the buffer, applying the overflow policy if it is full. Returns false if the record has to
+    // be discarded.
+    bool push(ThreadBuffer &buffer, const LogRecord &record, LogOverflowPolicy policy)
+    {
+        if (buffer.records.tryPush(record))
+        {
+            return true;
+        }
+
+        if (policy == LogOverflowPolicy::DROP_OLDEST)
+        {
+            // The worker may hold the slot the push needs, so give up after a few attempts rather than spin on it
+            for (int attempt = 0; attempt < DROP_OLDEST_ATTEMPTS; ++attempt)
+            {
+                LogRecord oldest;
+                if (buffer.records.tryPop(oldest))
+                {
+                    destroyRecord(oldest);
+                    countDropped(buffer);
+                }
+                if (buffer.records.tryPush(record))
+                {
+                    return true;
+                }
+            }
+        }
+        else if (policy == LogOverflowPolicy::BLOCK)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + block_timeout_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                const auto key = space_.prepareWait();
+                if (buffer.records.tryPush(record))
+                {
+                    space_.cancelWait();
+                    return true;
+                }
+                // Make sure the worker is awake to free some space
+                wake_.notifyOne();
+                if (!space_.waitUntil(key, deadline))
+                {
+                    return buffer.records.tryPush(record);
+                }
+            }
+        }
+        return false;
+    }
+
+    static void countDropped(ThreadBuffer &buffer) noexcept
+    {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+    }
+
+    static void destroyRecord(const LogRecord &record)
+    {
+        if (record.format->destroy != nullptr)
+        {
+            record.format->destroy(record.payload);
+        }
+    }
+
+    // Returns the buffer of the calling thread, creating it on the first message of the thread
+    ThreadBuffer &threadBuffer()
+    {
+        static thread_local ThreadBufferCache cache;
+        for (const auto &entry : cache.entries)
+        {
+            if (entry.first == id_)
+            {
+                return *entry.second;
+            }
+        }
+
+        // Forget the buffers of destroyed loggers
+        cache.entries.erase(std::remove_if(cache.entries.begin(), cache.entries.end(),
+                                           [](const auto &entry) {
+                                               return entry.second->orphaned.load(std::memory_order_acquire);
+                                           }),
+                            cache.entries.end());
+
+        auto buffer = std::make_shared<ThreadBuffer>(max_log_messages_within_buffer_, currentThreadId());
+        {
+            const std::lock_guard<std::mutex> lock{buffers_mutex_};
+            buffers_.push_back(buffer);
+            buffers_changed_.store(true, std::memory_order_release);
+        }
+        cache.entries.emplace_back(id_, buffer);
+        return *buffer;
+    }
+
+    static std::uint32_t currentThreadId() noexcept
+    {
+#if defined(__linux__)
+        return static_cast<std::uint32_t>(::syscall(SYS_gettid));
+#else
+        return static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
     }
 
     void processLogs()
     {
-        while (!exit_.load())
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        auto last_drop_report = std::chrono::steady_clock::now();
+        for (;;)
         {
-            std::unique_lock<std::mutex> lock(mutex_);
-            condition_.wait(lock, [this] { return !queue_.empty() || exit_.load(); });
+            // Read before draining: once exit is requested, nothing is logged anymore, so an empty pass is final
+            const bool exiting = exit_.load(std::memory_order_acquire);
+            const std::uint64_t flush_requested = flush_requested_.load(std::memory_order_acquire);
 
-            if (exit_.load() && queue_.empty())
+            if (buffers_changed_.exchange(false, std::memory_order_acq_rel))
             {
+                const std::lock_guard<std::mutex> lock{buffers_mutex_};
+                buffers = buffers_;
+            }
+
+            const std::size_t drained = drainBuffers(buffers);
+            if (drained > 0U)
+            {
+                space_.notifyAll();
+            }
+
+            const auto next_drop_report = last_drop_report + drop_report_interval_.load(std::memory_order_relaxed);
+            if (std::chrono::steady_clock::now() >= next_drop_report)
+            {
+                reportDroppedMessages(buffers);
+                reportSinkErrors();
+                last_drop_report = std::chrono::steady_clock::now();
+            }
+            writeBatch();
+
+            if (drained > 0U)
+            {
+                continue;
+            }
+
+            // Everything logged before the flush requests was written by this empty pass
+            if (exiting)
+            {
+                reportDroppedMessages(buffers);
+                reportSinkErrors();
+                writeBatch();
+                flushSinks();
+                completeFlushRequests(flush_requested);
                 break;
             }
+            if (flush_completed_ != flush_requested)
+            {
+                flushSinks();
+                completeFlushRequests(flush_requested);
+            }
+
+            const auto key = wake_.prepareWait();
+            if (exit_.load(std::memory_order_acquire) || buffers_changed_.load(std::memory_order_acquire) ||
+                (flush_requested_.load(std::memory_order_acquire) != flush_requested))
+            {
+                wake_.cancelWait();
+                continue;
+            }
+            if (hasPendingRecords(buffers))
+            {
+                // A producer has claimed a slot but not finished writing it
+                wake_.cancelWait();
+                std::this_thread::yield();
+                continue;
+            }
+            wake_.waitUntil(key, last_drop_report + drop_report_interval_.load(std::memory_order_relaxed));
+        }
+    }
+
+    // Writes one WARNING line with the messages dropped since the last report, if any
+    void reportDroppedMessages(const std::vector<std::shared_ptr<ThreadBuffer>> &buffers)
+    {
+        std::ostringstream report;
+        std::uint64_t total = dropped_by_exited_threads_;
+        for (const auto &buffer : buffers)
+        {
+            const std::uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+            if (dropped != buffer->dropped_reported)
+            {
+                report << ", thread " << buffer->thread_id << ": " << (dropped - buffer->dropped_reported);
+                total += dropped - buffer->dropped_reported;
+                buffer->dropped_reported = dropped;
+            }
+        }
+        if (total == 0U)
+        {
+            return;
+        }
+        if (dropped_by_exited_threads_ > 0U)
+        {
+            report << ", exited threads: " << dropped_by_exited_threads_;
+            dropped_by_exited_threads_ = 0U;
+        }
+
+        LogRecord record;
+        record.timestamp = CycleClock::now();
+        record.level = LogLevel::WARNING;
+        record.format = LogSerializer::encodeOversized(
+            record.payload, "Dropped " + std::to_string(total) + " log messages as the buffers were full (" +
+                                report.str().substr(2U) + ")");
+        batch_.push(record, currentThreadId());
+    }
+
+    // Writes one ERROR line with the sink writes that failed since the last report, if any. The failing sink gets the
+    // line as well: a sink that recovered, e.g. by reopening its file, records the gap.
+    void reportSinkErrors()
+    {
+        if (failed_sink_writes_ == 0U)
+        {
+            return;
+        }
+
+        LogRecord record;
+        record.timestamp = CycleClock::now();
+        record.level = LogLevel::ERROR;
+        record.format = LogSerializer::encodeOversized(
+            record.payload, "Failed to write " + std::to_string(failed_sink_writes_) +
+                                " log batches to a sink, last error: " + last_sink_error_);
+        batch_.push(record, currentThreadId());
+        failed_sink_writes_ = 0U;
+    }
+
+    void completeFlushRequests(std::uint64_t flush_requested)
+    {
+        const std::lock_guard<std::mutex> lock{flush_mutex_};
+        if (flush_completed_ != flush_requested)
+        {
+            flush_completed_ = flush_requested;
+            flush_condition_.notify_all();
+        }
+    }
+
+    // Moves the records of the buffers into the batch, writing it to the sinks whenever it is full. Returns the number
+    // of records moved.
+    std::size_t drainBuffers(std::vector<std::shared_ptr<ThreadBuffer>> &buffers)
+    {
+        std::size_t drained = 0U;
+        bool abandoned_buffers = false;
+        for (const auto &buffer : buffers)
+        {
+            // Read before draining: the owning thread logs nothing after setting the flag
+            const bool abandoned = buffer->abandoned.load(std::memory_order_acquire);
+
+            LogRecord record;
+            for (std::size_t count = 0U; (count < DRAIN_BATCH_SIZE) && buffer->records.tryPop(record); ++count)
+            {
+                batch_.push(record, buffer->thread_id);
+                ++drained;
+            }
+
+            if (batch_.size() >= SINK_BATCH_SIZE)
+            {
+                writeBatch();
+            }
+
+            abandoned_buffers = abandoned_buffers || abandoned;
+        }
+
+        if (abandoned_buffers)
+        {
+            removeAbandonedBuffers(buffers);
+        }
+        return drained;
+    }
+
+    // Drops the drained buffers of exited threads
+    void removeAbandonedBuffers(std::vector<std::shared_ptr<ThreadBuffer>> &buffers)
+    {
+        std::vector<std::shared_ptr<ThreadBuffer>> abandoned;
+        for (const auto &buffer : buffers)
+        {
+            if (buffer->abandoned.load(std::memory_order_acquire) && buffer->records.empty())
+            {
+                abandoned.push_back(buffer);
+            }
+        }
+
+        const auto is_abandoned = [&abandoned](const std::shared_ptr<ThreadBuffer> &buffer) {
+            return std::find(abandoned.begin(), abandoned.end(), buffer) != abandoned.end();
+        };
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(), is_abandoned), buffers.end());
+
+        const std::lock_guard<std::mutex> lock{buffers_mutex_};
+        buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), is_abandoned), buffers_.end());
+
+        // Keep the drops of the exited threads for the next report and for droppedMessages()
+        for (const auto &buffer : abandoned)
+        {
+            const std::uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+            dropped_by_exited_threads_ += dropped - buffer->dropped_reported;
+            dropped_by_released_buffers_.fetch_add(dropped, std::memory_order_relaxed);
+        }
+    }
+
+    static bool hasPendingRecords(const std::vector<std::shared_ptr<ThreadBuffer>> &buffers) noexcept
+    {
+        return std::any_of(buffers.begin(), buffers.end(),
+                           [](const auto &buffer) { return !buffer->records.empty(); });
+    }
 
-            std::string log_message;
-            if (!queue_.empty())
+    // Hands the batch to every sink and empties it
+    void writeBatch()
+    {
+        if (batch_.empty())
+        {
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock{sinks_mutex_};
+            for (const auto &sink : sinks_)
             {
-                log_message = queue_.front();
-                queue_.pop();
+                // A failing sink must not stop the others; its errors are reported with the dropped messages
+                try
+                {
+                    sink->write(batch_);
+                }
+                catch (const std::exception &error)
+                {
+                    ++failed_sink_writes_;
+                    last_sink_error_ = error.what();
+                }
             }
-            lock.unlock();
+        }
+        batch_.clear();
+    }
 
-            if (!log_message.empty())
+    void flushSinks()
+    {
+        const std::lock_guard<std::mutex> lock{sinks_mutex_};
+        for (const auto &sink : sinks_)
+        {
+            try
+            {
+                sink->flush();
+            }
+            catch (const std::exception &)
             {
-                std::cout << log_message << std::endl;
             }
         }
     }
 
-  protected:
+  public:
+    // Every logging thread gets a buffer of max_log_messages_within_buffer records. Messages go to the standard
+    // output until the sinks are changed.
+    explicit ThreadSafeLogger(std::uint32_t max_log_messages_within_buffer = 10'000)
+        : id_(next_id_.fetch_add(1U, std::memory_order_relaxed)),
+          max_log_messages_within_buffer_(max_log_messages_within_buffer)
+    {
+        worker_ = std::thread(&ThreadSafeLogger::processLogs, this);
+    }
+
     ~ThreadSafeLogger()
     {
-        exit_ = true;
-        condition_.notify_one();
+        exit_.store(true, std::memory_order_release);
+        wake_.notifyAll();
         worker_.join();
+        sinks_.clear();
+
+        const std::lock_guard<std::mutex> lock{buffers_mutex_};
+        for (const auto &buffer : buffers_)
+        {
+            buffer->orphaned.store(true, std::memory_order_release);
+        }
     }
 
-  public:
     // Delete the copy and move constructors and assignment operators
     ThreadSafeLogger(const ThreadSafeLogger &) = delete;
     ThreadSafeLogger(ThreadSafeLogger &&) noexcept = delete;
     ThreadSafeLogger &operator=(const ThreadSafeLogger &) = delete;
     ThreadSafeLogger &operator=(ThreadSafeLogger &&) noexcept = delete;
 
+    // Process-wide logger. The buffer size of the first call is used.
     static ThreadSafeLogger &getInstance(std::uint32_t max_log_messages)
     {
         ThreadSafeLogger::setMaxLogMessagesOnce(max_log_messages);
@@ -94,27 +585,139 @@ class ThreadSafeLogger final
         return instance;
     }
 
-    template <typename... Args> void log(Args... args)
+    // Logs the concatenation of the arguments as one line if the level is enabled
+    template <typename... Args> void log(LogLevel level, const Args &...args)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        // If there's room for a new log message, add it
-        if (queue_.size() < max_log_messages_within_buffer_)
+        if (isEnabled(level))
         {
-            std::ostringstream msg;
-            (msg << ... << args);
-            queue_.push(msg.str());
-            condition_.notify_one();
+            enqueue(level, LogSerializer::toStored(args)...);
         }
-        else
+    }
+
+    // Logs the concatenation of the arguments as one line at the INFO level
+    template <typename... Args> void log(const Args &...args)
+    {
+        log(LogLevel::INFO, args...);
+    }
+
+    // Whether messages of the level are logged, considering both the compile-time and the runtime threshold
+    [[nodiscard]] bool isEnabled(LogLevel level) const noexcept
+    {
+        return isLogLevelCompiledIn(level) && (level >= level_.load(std::memory_order_relaxed)) &&
+               (level != LogLevel::OFF);
+    }
+
+    // Sets the runtime threshold: messages below the level are discarded. LogLevel::OFF disables logging.
+    void setLevel(LogLevel level) noexcept
+    {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] LogLevel level() const noexcept
+    {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    // Selects what log() does when the calling thread's buffer is full
+    void setOverflowPolicy(LogOverflowPolicy policy) noexcept
+    {
+        overflow_policy_.store(policy, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] LogOverflowPolicy overflowPolicy() const noexcept
+    {
+        return overflow_policy_.load(std::memory_order_relaxed);
+    }
+
+    // Longest time log() waits for room in the buffer with LogOverflowPolicy::BLOCK
+    void setBlockTimeout(std::chrono::nanoseconds timeout) noexcept
+    {
+        block_timeout_.store(timeout, std::memory_order_relaxed);
+    }
+
+    // With LogOverflowPolicy::SAMPLE, one in every sample_rate messages is kept once a buffer is half full
+    void setSampleRate(std::uint32_t sample_rate) noexcept
+    {
+        sample_rate_.store(sample_rate, std::memory_order_relaxed);
+    }
+
+    // Period of the WARNING line that reports dropped messages
+    void setDropReportInterval(std::chrono::nanoseconds interval) noexcept
+    {
+        drop_report_interval_.store(interval, std::memory_order_relaxed);
+        wake_.notifyAll();
+    }
+
+    // Number of messages discarded since the logger was created
+    [[nodiscard]] std::uint64_t droppedMessages()
+    {
+        std::uint64_t dropped = dropped_by_released_buffers_.load(std::memory_order_relaxed);
+        const std::lock_guard<std::mutex> lock{buffers_mutex_};
+        for (const auto &buffer : buffers_)
         {
-            // Drop the message or print a warning/error here if you wish
-            std::cout << "Dropping message as the queue is full" << std::endl;
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
         }
+        return dropped;
+    }
+
+    // Blocks until every message logged before the call has been written to the sinks and the sinks are flushed
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock{flush_mutex_};
+        const std::uint64_t request = flush_requested_.fetch_add(1U, std::memory_order_acq_rel) + 1U;
+        wake_.notifyAll();
+        flush_condition_.wait(lock, [this, request]() { return flush_completed_ >= request; });
     }
-};
 
-std::atomic_bool ThreadSafeLogger::max_log_messages_set_ = false;
+    // Sends the following messages to the sink as well
+    void addSink(std::shared_ptr<LogSink> sink)
+    {
+        const std::lock_guard<std::mutex> lock{sinks_mutex_};
+        sinks_.push_back(std::move(sink));
+    }
+
+    // Stops sending messages to the sink. Once this returns, the logger no longer uses the sink.
+    void removeSink(const std::shared_ptr<LogSink> &sink)
+    {
+        const std::lock_guard<std::mutex> lock{sinks_mutex_};
+        sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), sink), sinks_.end());
+    }
+
+    // Replaces all sinks; an empty list discards the messages
+    void setSinks(std::vector<std::shared_ptr<LogSink>> sinks)
+    {
+        const std::lock_guard<std::mutex> lock{sinks_mutex_};
+        sinks_ = std::move(sinks);
+    }
+};
 } // namespace common_library::concurrency
 
-#endif // COMMON_LIBRARY_CONCURRENCY_THREAD_SAFE_LOGGER
\ No newline at end of file
+// Logs the arguments at the level if it is enabled. The arguments are not evaluated otherwise, and the whole statement
+// is discarded at compile time if the level is below COMMON_LIBRARY_LOG_MIN_LEVEL.
+#define COMMON_LIBRARY_LOG(logger, level, ...)                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if constexpr (::common_library::concurrency::isLogLevelCompiledIn(level))                                      \
+        {                                                                                                              \
+            auto &common_library_logger_ = (logger);                                                                   \
+            if (common_library_logger_.isEnabled(level))                                                               \
+            {                                                                                                          \
+                common_library_logger_.log(level, __VA_ARGS__);                                                        \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (false)
+
+#define COMMON_LIBRARY_LOG_TRACE(logger, ...)                                                                          \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::TRACE, __VA_ARGS__)
+#define COMMON_LIBRARY_LOG_DEBUG(logger, ...)                                                                          \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::DEBUG, __VA_ARGS__)
+#define COMMON_LIBRARY_LOG_INFO(logger, ...)                                                                           \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::INFO, __VA_ARGS__)
+#define COMMON_LIBRARY_LOG_WARNING(logger, ...)                                                                        \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::WARNING, __VA_ARGS__)
+#define COMMON_LIBRARY_LOG_ERROR(logger, ...)                                                                          \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::ERROR, __VA_ARGS__)
+#define COMMON_LIBRARY_LOG_CRITICAL(logger, ...)                                                                       \
+    COMMON_LIBRARY_LOG(logger, ::common_library::concurrency::LogLevel::CRITICAL, __VA_ARGS__)
+
+#endif // COMMON_LIBRARY_CONCURRENCY_THREAD_SAFE_LOGGER
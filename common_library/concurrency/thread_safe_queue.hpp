@@ -11,50 +11,87 @@
 namespace common_library::concurrency
 {
 // Thread Safe Queue
+//
+// A single mutex guards the queue; see ShardedThreadSafeQueue for many producers and consumers.
+//
+// close() stops the queue without losing items: push() rejects new items from then on, while pop() keeps returning
+// the remaining ones and returns an empty optional once the queue is empty. Destroying the queue makes pop() return
+// an empty optional at once.
 template <typename T> class ThreadSafeQueue final
 {
   private:
     std::queue<T> queue_;
     mutable std::mutex mutex_;
     std::condition_variable cv_;
+    // Notified when pop() takes the last item
+    std::condition_variable drained_cv_;
+    std::atomic_bool closed_{false};
     std::atomic_bool destructing_{false};
 
+  public:
     ThreadSafeQueue() = default;
     ThreadSafeQueue(const ThreadSafeQueue &other) = delete;
-
-  public:
     ThreadSafeQueue &operator=(const ThreadSafeQueue &other) = delete;
 
+    // Process-wide queue of the value type, for code that has no queue instance to share
     [[nodiscard]] static ThreadSafeQueue<T> &getInstance()
     {
         static ThreadSafeQueue<T> instance;
         return instance;
     }
 
-    void push(T value)
+    // Returns false if the value was rejected because the queue is closed
+    bool push(T value)
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        if (destructing_)
+        if (destructing_ || closed_)
         {
-            return;
+            return false;
         }
         queue_.push(std::move(value));
         cv_.notify_one();
+        return true;
     }
 
+    // Waits for a value. Returns an empty optional if the queue is closed and empty, or being destroyed.
     std::optional<T> pop()
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return !queue_.empty() || destructing_; });
-        if (destructing_)
+        cv_.wait(lock, [this]() { return !queue_.empty() || closed_ || destructing_; });
+        if (destructing_ || queue_.empty())
         {
             return {};
         }
         T value = std::move(queue_.front());
         queue_.pop();
+        if (queue_.empty())
+        {
+            drained_cv_.notify_all();
+        }
         return value;
     }
 
+    // Rejects every push from now on; pop() still returns the values already queued
+    void close()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        closed_.store(true);
+        cv_.notify_all();
+    }
+
+    [[nodiscard]] bool closed() const noexcept
+    {
+        return closed_.load();
+    }
+
+    // Blocks until the queue is empty, e.g. after close() until the consumers have taken every value. Returns early
+    // if the queue is being destroyed.
+    void waitUntilDrained()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_cv_.wait(lock, [this]() { return queue_.empty() || destructing_; });
+    }
+
     [[nodiscard]] bool empty() const
     {
         std::lock_guard<std::mutex> lock{mutex_};
@@ -70,6 +107,7 @@ template <typename T> class ThreadSafeQueue final
         std::lock_guard<std::mutex> lock{mutex_};
         destructing_.store(true);
         cv_.notify_all();
+        drained_cv_.notify_all();
     }
 };
 } // namespace common_library::concurrency
@@ -0,0 +1,182 @@
+#ifndef COMMON_LIBRARY_CONCURRENCY_WORK_STEALING_DEQUE
+#define COMMON_LIBRARY_CONCURRENCY_WORK_STEALING_DEQUE
+
+#include <common_library/concurrency/cache_line.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace common_library::concurrency
+{
+// Chase-Lev work-stealing deque, with the memory orderings of Le, Pop, Cohen and Zappa Nardelli, "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+//
+// One thread, the owner, pushes and pops at the bottom end in LIFO order. Any number of other threads steal from the
+// top end in FIFO order. Only the last value is contended: the owner and the thieves race for it with a CAS on top.
+//
+// The buffer doubles when full. Thieves may still be reading from a replaced buffer, so replaced buffers are kept
+// until the deque is destroyed; as each is half the size of the next, they take at most as much memory as the
+// current one.
+//
+// T is copied with atomic loads and stores, so it must be trivially copyable and lock-free as a std::atomic, which
+// pointers and integers are.
+template <typename T> class WorkStealingDeque final
+{
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque: T must be trivially copyable");
+    static_assert(std::atomic<T>::is_always_lock_free, "WorkStealingDeque: std::atomic<T> must be lock-free");
+
+  private:
+    class Buffer final
+    {
+      public:
+        explicit Buffer(std::size_t capacity)
+            : mask_(static_cast<std::int64_t>(capacity) - 1), slots_(new std::atomic<T>[capacity])
+        {
+        }
+
+        [[nodiscard]] std::int64_t capacity() const noexcept
+        {
+            return mask_ + 1;
+        }
+
+        [[nodiscard]] T load(std::int64_t index) const noexcept
+        {
+            return slots_[index & mask_].load(std::memory_order_relaxed);
+        }
+
+        void store(std::int64_t index, T value) noexcept
+        {
+            slots_[index & mask_].store(value, std::memory_order_relaxed);
+        }
+
+      private:
+        const std::int64_t mask_;
+        const std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+    // Next position to steal from, advanced by the thieves and by the owner when it pops the last value
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> top_{0};
+    // Next position to push to, written by the owner only
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Buffer *> buffer_;
+    // Current and replaced buffers, owned by the deque; accessed by the owner only
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+    // Copies the values in [top, bottom) into a buffer of twice the capacity and publishes it
+    Buffer *grow(Buffer *buffer, std::int64_t top, std::int64_t bottom)
+    {
+        buffers_.push_back(std::make_unique<Buffer>(static_cast<std::size_t>(buffer->capacity()) * 2U));
+        Buffer *larger = buffers_.back().get();
+        for (std::int64_t i = top; i < bottom; ++i)
+        {
+            larger->store(i, buffer->load(i));
+        }
+        buffer_.store(larger, std::memory_order_release);
+        return larger;
+    }
+
+  public:
+    // The capacity is rounded up to a power of two. Throws std::invalid_argument if it is zero.
+    explicit WorkStealingDeque(std::size_t initial_capacity = 256U)
+    {
+        if (initial_capacity == 0U)
+        {
+            throw std::invalid_argument("WorkStealingDeque: initial_capacity must be positive");
+        }
+        buffers_.push_back(std::make_unique<Buffer>(roundUpToPowerOfTwo(initial_capacity)));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &other) = delete;
+    WorkStealingDeque(WorkStealingDeque &&other) noexcept = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &other) = delete;
+    WorkStealingDeque &operator=(WorkStealingDeque &&other) noexcept = delete;
+
+    ~WorkStealingDeque() = default;
+
+    // Owner only: appends the value at the bottom. Throws std::bad_alloc if the buffer cannot grow.
+    void push(T value)
+    {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t top = top_.load(std::memory_order_acquire);
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity() - 1)
+        {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->store(bottom, value);
+        // Publishes the value to the thieves, which load bottom with acquire
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only: takes the most recently pushed value. Returns false if the deque is empty or a thief took the last
+    // value.
+    [[nodiscard]] bool pop(T &value) noexcept
+    {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+        // Reserve the bottom value before looking at top, so that thieves see the reservation
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        value = buffer->load(bottom);
+        if (top < bottom)
+        {
+            // More than one value: the bottom one cannot be stolen
+            return true;
+        }
+
+        // Last value: race the thieves for it
+        const bool won =
+            top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // Any thread: takes the least recently pushed value. Returns false if the deque is empty or another thread took
+    // the value first.
+    [[nodiscard]] bool steal(T &value) noexcept
+    {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return false;
+        }
+
+        value = buffer_.load(std::memory_order_acquire)->load(top);
+        return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // The observers below are exact only when no other thread is pushing, popping or stealing at the same time.
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t top = top_.load(std::memory_order_relaxed);
+        return (bottom > top) ? static_cast<std::size_t>(bottom - top) : 0U;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return (size() == 0U);
+    }
+};
+} // namespace common_library::concurrency
+
+#endif // COMMON_LIBRARY_CONCURRENCY_WORK_STEALING_DEQUE
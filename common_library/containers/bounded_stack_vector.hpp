@@ -1,15 +1,20 @@
 #ifndef COMMON_LIBRARY_CONTAINERS_BOUNDED_STACK_VECTOR
 #define COMMON_LIBRARY_CONTAINERS_BOUNDED_STACK_VECTOR
 
-#include <algorithm>        // std::move_backward
-#include <array>            // std::array
+#include <common_library/containers/trivially_relocatable.hpp>
+
+#include <algorithm>        // std::move_backward, std::swap_ranges
 #include <cstddef>          // std::ptrdiff_t
 #include <cstdint>          // std::size_t
+#include <cstring>          // std::memcpy, std::memmove
 #include <initializer_list> // std::initializer_list
 #include <iostream>         // std::cout
 #include <iterator>         // std::reverse_iterator, std::distance
+#include <memory>           // std::destroy, std::uninitialized_copy_n, std::uninitialized_move_n
+#include <new>              // placement new, std::launder
 #include <stdexcept>        // std::overflow_error, std::underflow_error
 #include <string_view>      // std::swap
+#include <type_traits>      // std::is_trivially_copyable_v
 #include <utility>          // std::move
 
 namespace common_library::containers
@@ -55,11 +60,21 @@ class BoundedStackVectorInvalidIndexAccess : public std::out_of_range
     }
 };
 
-/// @brief BoundedStackVector is a wrapper class around std::array that implements stack allocated resizable vector
+/// @brief BoundedStackVector implements stack allocated resizable vector with a capacity of N elements
+/// @details The storage is left uninitialized: only the first size() slots hold live objects, which push_back and
+/// emplace_back construct in place and pop_back, erase and clear destroy. Creating a BoundedStackVector costs O(1)
+/// whatever N and T are.
+///
+/// insert, emplace and erase shift the elements after the position with a single memmove, and moves and swap relocate
+/// the elements in use with memcpy, when T is trivially copyable or opts in to is_trivially_relocatable.
 /// @tparam T Type of the values
 /// @tparam N Number of elements
 template <typename T, std::size_t N> class BoundedStackVector final
 {
+  private:
+    static constexpr bool IS_TRIVIALLY_COPYABLE = std::is_trivially_copyable_v<T>;
+    static constexpr bool IS_TRIVIALLY_RELOCATABLE = is_trivially_relocatable_v<T>;
+
   public:
     using value_type = T;
     using size_type = std::size_t;
@@ -78,31 +93,42 @@ template <typename T, std::size_t N> class BoundedStackVector final
     {
     }
 
-    /// @brief Default destructor of the BoundedStackVector class.
+    /// @brief Destructor of the BoundedStackVector class, destroys the elements in use.
     ~BoundedStackVector()
     {
-        size_ = 0;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            std::destroy_n(begin(), size_);
+        }
     }
 
     /// @brief Constructor of the BoundedStackVector class from the initializer list.
     /// @param initializer_list initializer list to move data from to the BoundedStackVector's data.
     /// @throws BoundedStackVectorInitializationError if initializer list contains more elements that Vector's maximum
     /// capacity
-    BoundedStackVector(std::initializer_list<T> initializer_list)
+    BoundedStackVector(std::initializer_list<T> initializer_list) : size_(0)
     {
         if (initializer_list.size() > N)
         {
             throw BoundedStackVectorInitializationError();
         }
+        std::uninitialized_copy(initializer_list.begin(), initializer_list.end(), begin());
         size_ = initializer_list.size();
-        std::move(std::make_move_iterator(initializer_list.begin()), std::make_move_iterator(initializer_list.end()),
-                  data_.begin());
     }
 
     /// @brief Copy constructor.
     /// @param other The object to copy data from.
-    BoundedStackVector(const BoundedStackVector &other) : data_(other.data_), size_(other.size_)
+    BoundedStackVector(const BoundedStackVector &other) : size_(0)
     {
+        if constexpr (IS_TRIVIALLY_COPYABLE)
+        {
+            std::memcpy(static_cast<void *>(storage_), other.storage_, other.size_ * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_copy_n(other.cbegin(), other.size_, begin());
+        }
+        size_ = other.size_;
     }
 
     /// @brief Copy assignment operator.
@@ -115,17 +141,16 @@ template <typename T, std::size_t N> class BoundedStackVector final
             return *this;
         }
 
-        data_ = other.data_;
-        size_ = other.size_;
+        copyElements(other);
 
         return *this;
     }
 
     /// @brief Move constructor.
     /// @param other Other BoundedStackVector to move data from.
-    BoundedStackVector(BoundedStackVector &&other) noexcept : data_(std::move(other.data_)), size_(other.size_)
+    BoundedStackVector(BoundedStackVector &&other) noexcept : size_(other.size_)
     {
-        other.size_ = 0;
+        relocateElements(other);
     }
 
     /// @brief Move operator.
@@ -138,9 +163,9 @@ template <typename T, std::size_t N> class BoundedStackVector final
             return *this;
         }
 
-        data_ = std::move(other.data_);
+        clear();
         size_ = other.size_;
-        other.size_ = 0;
+        relocateElements(other);
 
         return *this;
     }
@@ -149,7 +174,20 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @param other Other BoundedStackVector to exchange data with.
     void swap(BoundedStackVector &other) noexcept
     {
-        data_.swap(other.data_);
+        if constexpr (IS_TRIVIALLY_RELOCATABLE)
+        {
+            // Exchanging the bytes of the slots in use in either vector relocates the elements of both
+            const size_type count = std::max(size_, other.size_);
+            std::swap_ranges(storage_, storage_ + count * sizeof(T), other.storage_);
+        }
+        else
+        {
+            BoundedStackVector &shorter = (size_ < other.size_) ? *this : other;
+            BoundedStackVector &longer = (size_ < other.size_) ? other : *this;
+            std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+            std::uninitialized_move(longer.begin() + shorter.size_, longer.end(), shorter.end());
+            std::destroy(longer.begin() + shorter.size_, longer.end());
+        }
         std::swap(size_, other.size_);
     }
 
@@ -177,6 +215,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @brief Resizes BoundedStackVector to 0
     void clear() noexcept
     {
+        std::destroy_n(begin(), size_);
         size_ = 0UL;
     }
 
@@ -189,7 +228,8 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorOverflow();
         }
-        data_[size_++] = value;
+        ::new (static_cast<void *>(end())) T(value);
+        ++size_;
     }
 
     /// @brief Move a value to the end of the BoundedStackVector.
@@ -201,20 +241,24 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorOverflow();
         }
-        data_[size_++] = std::move(value);
+        ::new (static_cast<void *>(end())) T(std::move(value));
+        ++size_;
     }
 
     /// @brief Add a value to the end of the BoundedStackVector.
     /// @tparam ...Args Argument types forwarded to construct the new element.
     /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the new element.
     /// @throws BoundedStackVectorOverflow if the BoundedStackVector is full.
-    template <typename... Args> void emplace_back(Args &&...args)
+    template <typename... Args> reference emplace_back(Args &&...args)
     {
         if (size_ >= N)
         {
             throw BoundedStackVectorOverflow();
         }
-        data_[size_++] = T(std::forward<Args>(args)...);
+        T *element = ::new (static_cast<void *>(end())) T(std::forward<Args>(args)...);
+        ++size_;
+        return *element;
     }
 
     /// @brief Construct and insert element at the specified position of the BoundedStackVector.
@@ -226,24 +270,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @throws BoundedStackVectorInvalidIteratorAccess if the invalid iterator position was provided.
     template <typename... Args> iterator emplace(iterator pos, Args &&...args)
     {
-        if (size_ >= N)
-        {
-            throw BoundedStackVectorOverflow();
-        }
-
-        if (pos < begin() || pos > end())
-        {
-            throw BoundedStackVectorInvalidIteratorAccess();
-        }
-
-        if (pos != end())
-        {
-            std::move_backward(pos, end(), end() + 1);
-        }
-        *pos = T(std::forward<Args>(args)...);
-
-        ++size_;
-        return pos;
+        return insertAt(pos, std::forward<Args>(args)...);
     }
 
     /// @brief Remove one element from the end of the BoundedStackVector.
@@ -255,6 +282,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
             throw BoundedStackVectorUnderflow();
         }
         --size_;
+        std::destroy_at(end());
     }
 
     /// @brief Insert an element at a specified position.
@@ -266,20 +294,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @throws BoundedStackVectorInvalidIteratorAccess error if the provided insert position is out of range.
     iterator insert(iterator pos, const T &value)
     {
-        if (size_ >= N)
-        {
-            throw BoundedStackVectorOverflow();
-        }
-        if (pos < begin() || pos > end())
-        {
-            throw BoundedStackVectorInvalidIteratorAccess();
-        }
-
-        std::move_backward(pos, end(), end() + 1);
-        *pos = value;
-        ++size_;
-
-        return pos;
+        return insertAt(pos, value);
     }
 
     /// @brief Insert an element at a specified position.
@@ -291,20 +306,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @throws BoundedStackVectorInvalidIteratorAccess error if the provided insert position is out of range.
     iterator insert(iterator pos, T &&value)
     {
-        if (size_ >= N)
-        {
-            throw BoundedStackVectorOverflow();
-        }
-        if (pos < begin() || pos > end())
-        {
-            throw BoundedStackVectorInvalidIteratorAccess();
-        }
-
-        std::move_backward(pos, end(), end() + 1);
-        *pos = std::move(value);
-        ++size_;
-
-        return pos;
+        return insertAt(pos, std::move(value));
     }
 
     /// @brief Removes from the BoundedStackVector a single element.
@@ -318,9 +320,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
             throw BoundedStackVectorInvalidIteratorAccess();
         }
 
-        iterator next = pos + 1;
-        std::move(next, end(), pos);
-        --size_;
+        eraseRange(pos, pos + 1);
 
         return pos;
     }
@@ -337,8 +337,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
             throw BoundedStackVectorInvalidIteratorAccess();
         }
 
-        iterator new_end = std::move(last, end(), first);
-        size_ -= std::distance(first, last);
+        eraseRange(first, last);
 
         return first;
     }
@@ -348,7 +347,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @return Non-const reference to the element in the data.
     [[nodiscard]] reference operator[](size_type index) noexcept
     {
-        return data_[index];
+        return elements()[index];
     }
 
     /// @brief Get a constant reference to the element stored at the specified position.
@@ -356,48 +355,61 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @return Const reference to the element in the data.
     [[nodiscard]] const_reference operator[](size_type index) const noexcept
     {
-        return data_[index];
+        return elements()[index];
     }
 
     /// @brief Get a reference to the element stored at the specified position.
     /// @param index Index to the element stored in the BoundedStackVector.
     /// @return Non-const reference to the element in the data.
     /// @throws BoundedStackVectorInvalidIndexAccess If the index is out of range.
-    [[nodiscard]] reference at(size_type index) const
+    [[nodiscard]] reference at(size_type index)
     {
         if (index >= size_)
         {
             throw BoundedStackVectorInvalidIndexAccess();
         }
-        return data_[index];
+        return elements()[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the BoundedStackVector.
+    /// @return Const reference to the element in the data.
+    /// @throws BoundedStackVectorInvalidIndexAccess If the index is out of range.
+    [[nodiscard]] const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw BoundedStackVectorInvalidIndexAccess();
+        }
+        return elements()[index];
     }
 
     /// @brief Returns an iterator pointing to the first element in the BoundedStackVector.
     /// @return Non-const pointer to the first position of the data stored within the BoundedStackVector.
     [[nodiscard]] iterator begin() noexcept
     {
-        return data_.data();
+        return elements();
     }
 
     /// @brief Returns an iterator pointing to the first element in the BoundedStackVector.
     /// @return Const pointer to the first position of the data stored within the BoundedStackVector.
     [[nodiscard]] const_iterator cbegin() const noexcept
     {
-        return data_.data();
+        return elements();
     }
 
     /// @brief Returns an iterator referring to the element one past the end position of the BoundedStackVector.
     /// @return Non-const pointer to the past-the-end position of the data stored within the BoundedStackVector.
     [[nodiscard]] iterator end() noexcept
     {
-        return data_.data() + size_;
+        return elements() + size_;
     }
 
     /// @brief Returns an iterator referring to the element one past the end position of the BoundedStackVector.
     /// @return Const pointer to the past-the-end position of the data stored within the BoundedStackVector.
     [[nodiscard]] const_iterator cend() const noexcept
     {
-        return data_.data() + size_;
+        return elements() + size_;
     }
 
     /// @brief Returns a reverse iterator pointing to the last element in the BoundedStackVector.
@@ -411,7 +423,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// @return Const pointer to the last element of the data stored within the BoundedStackVector.
     [[nodiscard]] const_reverse_iterator crbegin() const noexcept
     {
-        return const_reverse_iterator(end());
+        return const_reverse_iterator(cend());
     }
 
     /// @brief Returns a reverse iterator pointing to the before the start element in the BoundedStackVector.
@@ -427,7 +439,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
     /// element.
     [[nodiscard]] const_reverse_iterator crend() const noexcept
     {
-        return const_reverse_iterator(begin());
+        return const_reverse_iterator(cbegin());
     }
 
     /// @brief Returns the non-const reference to the first element in the BoundedStackVector.
@@ -438,7 +450,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorUnderflow();
         }
-        return data_[0];
+        return *elements();
     }
 
     /// @brief Returns the const reference to the first element in the BoundedStackVector.
@@ -449,7 +461,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorUnderflow();
         }
-        return data_[0];
+        return *elements();
     }
 
     /// @brief Returns the non-const reference to the last element in the BoundedStackVector.
@@ -460,7 +472,7 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorUnderflow();
         }
-        return data_[size_ - 1];
+        return elements()[size_ - 1];
     }
 
     /// @brief Returns the const reference to the last element in the BoundedStackVector.
@@ -471,12 +483,125 @@ template <typename T, std::size_t N> class BoundedStackVector final
         {
             throw BoundedStackVectorUnderflow();
         }
-        return data_[size_ - 1];
+        return elements()[size_ - 1];
     }
 
   private:
-    std::array<T, N> data_;
+    alignas(T) unsigned char storage_[sizeof(T) * N];
     size_type size_;
+
+    /// @brief Pointer to the first slot of the storage.
+    [[nodiscard]] pointer elements() noexcept
+    {
+        return std::launder(reinterpret_cast<pointer>(storage_));
+    }
+
+    /// @brief Const pointer to the first slot of the storage.
+    [[nodiscard]] const_pointer elements() const noexcept
+    {
+        return std::launder(reinterpret_cast<const_pointer>(storage_));
+    }
+
+    /// @brief Assigns over the elements both BoundedStackVectors have, then constructs or destroys the rest.
+    void copyElements(const BoundedStackVector &other)
+    {
+        if constexpr (IS_TRIVIALLY_COPYABLE)
+        {
+            std::memcpy(static_cast<void *>(storage_), other.storage_, other.size_ * sizeof(T));
+        }
+        else if (size_ < other.size_)
+        {
+            std::copy_n(other.cbegin(), size_, begin());
+            std::uninitialized_copy(other.cbegin() + size_, other.cend(), end());
+        }
+        else
+        {
+            std::copy_n(other.cbegin(), other.size_, begin());
+            std::destroy(begin() + other.size_, end());
+        }
+        size_ = other.size_;
+    }
+
+    /// @brief Moves the first size_ elements of the other BoundedStackVector into the uninitialized storage and leaves
+    /// the other BoundedStackVector empty.
+    void relocateElements(BoundedStackVector &other) noexcept
+    {
+        if constexpr (IS_TRIVIALLY_RELOCATABLE)
+        {
+            // The elements now live here: the other BoundedStackVector must not destroy them
+            std::memcpy(static_cast<void *>(storage_), other.storage_, size_ * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_move_n(other.begin(), size_, begin());
+            std::destroy_n(other.begin(), size_);
+        }
+        other.size_ = 0;
+    }
+
+    /// @brief Shifts the elements from pos to the end up by one and constructs the new element at pos.
+    /// @throws BoundedStackVectorOverflow if the BoundedStackVector is full.
+    /// @throws BoundedStackVectorInvalidIteratorAccess if the invalid iterator position was provided.
+    template <typename... Args> iterator insertAt(iterator pos, Args &&...args)
+    {
+        if (size_ >= N)
+        {
+            throw BoundedStackVectorOverflow();
+        }
+        if (pos < begin() || pos > end())
+        {
+            throw BoundedStackVectorInvalidIteratorAccess();
+        }
+
+        if constexpr (IS_TRIVIALLY_RELOCATABLE)
+        {
+            // Construct the new element aside first: the arguments may refer to elements that are about to move
+            alignas(T) unsigned char element[sizeof(T)];
+            ::new (static_cast<void *>(element)) T(std::forward<Args>(args)...);
+
+            std::memmove(static_cast<void *>(pos + 1), static_cast<const void *>(pos),
+                         static_cast<std::size_t>(end() - pos) * sizeof(T));
+            std::memcpy(static_cast<void *>(pos), element, sizeof(T));
+        }
+        else if (pos == end())
+        {
+            ::new (static_cast<void *>(pos)) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            // Construct the new element before shifting, for the same reason
+            T element(std::forward<Args>(args)...);
+            ::new (static_cast<void *>(end())) T(std::move(*(end() - 1)));
+            std::move_backward(pos, end() - 1, end());
+            *pos = std::move(element);
+        }
+
+        ++size_;
+        return pos;
+    }
+
+    /// @brief Removes the elements in [first, last), shifting the following elements down.
+    void eraseRange(iterator first, iterator last)
+    {
+        if (first == last)
+        {
+            // Moving the following elements onto themselves could empty them
+            return;
+        }
+
+        const auto count = static_cast<size_type>(last - first);
+        if constexpr (IS_TRIVIALLY_RELOCATABLE)
+        {
+            std::destroy(first, last);
+            std::memmove(static_cast<void *>(first), static_cast<const void *>(last),
+                         static_cast<std::size_t>(end() - last) * sizeof(T));
+        }
+        else
+        {
+            std::destroy(std::move(last, end(), first), end());
+        }
+        size_ -= count;
+    }
 };
 } // namespace common_library::containers
 
@@ -0,0 +1,439 @@
+#ifndef COMMON_LIBRARY_CONTAINERS_SMALL_VECTOR
+#define COMMON_LIBRARY_CONTAINERS_SMALL_VECTOR
+
+#include <common_library/containers/bounded_stack_vector.hpp>
+
+#include <algorithm>        // std::max
+#include <cstddef>          // std::ptrdiff_t
+#include <cstdint>          // std::size_t
+#include <initializer_list> // std::initializer_list
+#include <iterator>         // std::reverse_iterator, std::make_move_iterator
+#include <type_traits>      // std::is_nothrow_move_constructible_v, std::is_copy_constructible_v
+#include <utility>          // std::move, std::forward
+#include <vector>           // std::vector
+
+namespace common_library::containers
+{
+/// @brief SmallVector keeps up to N elements inline in a BoundedStackVector and spills them to a heap allocated
+/// std::vector when more are added, so that the common case of few elements never allocates.
+/// @details The API follows BoundedStackVector, including its iterators, which are plain pointers, and its exceptions
+/// for invalid positions and empty vectors, but adding an element never throws BoundedStackVectorOverflow.
+///
+/// Once spilled, the elements stay on the heap until the SmallVector is destroyed or assigned, even when fewer than N
+/// remain, so that a size oscillating around N does not move them back and forth. Spilling moves every element, which
+/// invalidates iterators and references like a reallocation of std::vector does.
+/// @tparam T Type of the values
+/// @tparam N Number of elements stored inline
+template <typename T, std::size_t N> class SmallVector final
+{
+    static_assert((N > 0), "Inline capacity of the SmallVector must be greater than 0");
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /// @brief Number of elements stored without allocating.
+    static constexpr size_type INLINE_CAPACITY = N;
+
+    /// @brief Default constructor of the SmallVector class, does not allocate.
+    SmallVector() = default;
+
+    /// @brief Constructor of the SmallVector class from the initializer list.
+    /// @param initializer_list initializer list to copy data from, spilled to the heap if larger than N.
+    SmallVector(std::initializer_list<T> initializer_list)
+    {
+        if (initializer_list.size() > N)
+        {
+            heap_.assign(initializer_list.begin(), initializer_list.end());
+            on_heap_ = true;
+        }
+        else
+        {
+            for (const auto &value : initializer_list)
+            {
+                inline_.push_back(value);
+            }
+        }
+    }
+
+    SmallVector(const SmallVector &other) = default;
+    SmallVector(SmallVector &&other) noexcept = default;
+    SmallVector &operator=(const SmallVector &other) = default;
+    SmallVector &operator=(SmallVector &&other) noexcept = default;
+    ~SmallVector() = default;
+
+    /// @brief Swap data between two SmallVector objects.
+    /// @param other Other SmallVector to exchange data with.
+    void swap(SmallVector &other) noexcept
+    {
+        inline_.swap(other.inline_);
+        heap_.swap(other.heap_);
+        std::swap(on_heap_, other.on_heap_);
+    }
+
+    /// @brief Returns whether the SmallVector is empty.
+    /// @return True if empty, else False.
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return (size() == 0UL);
+    }
+
+    /// @brief Gets the number of elements in the SmallVector.
+    /// @return Current data size.
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return on_heap_ ? heap_.size() : inline_.size();
+    }
+
+    /// @brief Get the number of elements the SmallVector can hold before it has to allocate.
+    /// @return N while the elements are inline, else the capacity of the heap storage.
+    [[nodiscard]] size_type capacity() const noexcept
+    {
+        return on_heap_ ? heap_.capacity() : N;
+    }
+
+    /// @brief Get the maximum number of elements the SmallVector can hold.
+    /// @return Maximum size of the heap storage.
+    [[nodiscard]] size_type max_size() const noexcept
+    {
+        return heap_.max_size();
+    }
+
+    /// @brief Returns whether the elements are stored inline, i.e. the SmallVector has not spilled to the heap.
+    /// @return True if inline, else False.
+    [[nodiscard]] bool is_inline() const noexcept
+    {
+        return !on_heap_;
+    }
+
+    /// @brief Makes room for at least capacity elements, spilling to the heap if capacity exceeds N.
+    /// @param capacity Number of elements to make room for.
+    void reserve(size_type capacity)
+    {
+        if (on_heap_)
+        {
+            heap_.reserve(capacity);
+        }
+        else if (capacity > N)
+        {
+            spill(capacity);
+        }
+    }
+
+    /// @brief Destroys all elements. The heap storage, if any, is kept.
+    void clear() noexcept
+    {
+        inline_.clear();
+        heap_.clear();
+    }
+
+    /// @brief Add a value to the end of SmallVector, spilling to the heap if N elements are inline.
+    /// @param value Value to be copied
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    /// @brief Move a value to the end of the SmallVector, spilling to the heap if N elements are inline.
+    /// @param value Value to be moved.
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    /// @brief Add a value to the end of the SmallVector, spilling to the heap if N elements are inline.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the new element.
+    template <typename... Args> reference emplace_back(Args &&...args)
+    {
+        if (on_heap_)
+        {
+            return heap_.emplace_back(std::forward<Args>(args)...);
+        }
+        if (inline_.size() < N)
+        {
+            return inline_.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // Construct the new element before spilling: the arguments may refer to elements that are about to move
+        T element(std::forward<Args>(args)...);
+        spill(2U * N);
+        return heap_.emplace_back(std::move(element));
+    }
+
+    /// @brief Construct and insert element at the specified position of the SmallVector, spilling to the heap if N
+    /// elements are inline.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param pos Random access iterator position that points to the insertion position in the SmallVector.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Iterator pointing to the new element.
+    /// @throws BoundedStackVectorInvalidIteratorAccess if the invalid iterator position was provided.
+    template <typename... Args> iterator emplace(iterator pos, Args &&...args)
+    {
+        if (pos < begin() || pos > end())
+        {
+            throw BoundedStackVectorInvalidIteratorAccess();
+        }
+        const auto index = pos - begin();
+
+        if (on_heap_)
+        {
+            return &*heap_.emplace(heap_.begin() + index, std::forward<Args>(args)...);
+        }
+        if (inline_.size() < N)
+        {
+            return inline_.emplace(pos, std::forward<Args>(args)...);
+        }
+
+        // Construct the new element before spilling, for the same reason as in emplace_back
+        T element(std::forward<Args>(args)...);
+        spill(2U * N);
+        return &*heap_.insert(heap_.begin() + index, std::move(element));
+    }
+
+    /// @brief Remove one element from the end of the SmallVector.
+    /// @throws BoundedStackVectorUnderflow if the SmallVector is empty.
+    void pop_back()
+    {
+        if (!on_heap_)
+        {
+            inline_.pop_back();
+            return;
+        }
+        if (heap_.empty())
+        {
+            throw BoundedStackVectorUnderflow();
+        }
+        heap_.pop_back();
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the SmallVector where the new element is inserted provided as a random access iterator.
+    /// @param value Value to be copied to the inserted element.
+    /// @return Iterator pointing to the new element.
+    /// @throws BoundedStackVectorInvalidIteratorAccess error if the provided insert position is out of range.
+    iterator insert(iterator pos, const T &value)
+    {
+        return emplace(pos, value);
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the SmallVector where the new element is inserted provided as a random access iterator.
+    /// @param value Value to be moved to the inserted element.
+    /// @return Iterator pointing to the new element.
+    /// @throws BoundedStackVectorInvalidIteratorAccess error if the provided insert position is out of range.
+    iterator insert(iterator pos, T &&value)
+    {
+        return emplace(pos, std::move(value));
+    }
+
+    /// @brief Removes from the SmallVector a single element.
+    /// @param pos Random access iterator position corresponding to the element to be removed.
+    /// @return Iterator following the removed element.
+    /// @throws BoundedStackVectorInvalidIteratorAccess if invalid position is provided.
+    [[nodiscard]] iterator erase(iterator pos)
+    {
+        if (pos < begin() || pos >= end())
+        {
+            throw BoundedStackVectorInvalidIteratorAccess();
+        }
+        return erase(pos, pos + 1);
+    }
+
+    /// @brief Removes from the SmallVector a range of elements [first, last).
+    /// @param first Random access iterator type to the first element to be removed.
+    /// @param last Random access iterator type to last non-inclusive element.
+    /// @return Iterator following the removed elements.
+    /// @throws BoundedStackVectorInvalidIteratorAccess if invalid position is provided.
+    [[nodiscard]] iterator erase(iterator first, iterator last)
+    {
+        if (!on_heap_)
+        {
+            return inline_.erase(first, last);
+        }
+        if (first < begin() || first > last || last > end())
+        {
+            throw BoundedStackVectorInvalidIteratorAccess();
+        }
+        const auto index = first - begin();
+        heap_.erase(heap_.begin() + index, heap_.begin() + (last - begin()));
+        return begin() + index;
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Non-const reference to the element in the data.
+    [[nodiscard]] reference operator[](size_type index) noexcept
+    {
+        return begin()[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Const reference to the element in the data.
+    [[nodiscard]] const_reference operator[](size_type index) const noexcept
+    {
+        return cbegin()[index];
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Non-const reference to the element in the data.
+    /// @throws BoundedStackVectorInvalidIndexAccess If the index is out of range.
+    [[nodiscard]] reference at(size_type index)
+    {
+        if (index >= size())
+        {
+            throw BoundedStackVectorInvalidIndexAccess();
+        }
+        return begin()[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Const reference to the element in the data.
+    /// @throws BoundedStackVectorInvalidIndexAccess If the index is out of range.
+    [[nodiscard]] const_reference at(size_type index) const
+    {
+        if (index >= size())
+        {
+            throw BoundedStackVectorInvalidIndexAccess();
+        }
+        return cbegin()[index];
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the SmallVector.
+    /// @return Non-const pointer to the first element, inline or on the heap.
+    [[nodiscard]] iterator begin() noexcept
+    {
+        return on_heap_ ? heap_.data() : inline_.begin();
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the SmallVector.
+    /// @return Const pointer to the first element, inline or on the heap.
+    [[nodiscard]] const_iterator cbegin() const noexcept
+    {
+        return on_heap_ ? heap_.data() : inline_.cbegin();
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the SmallVector.
+    /// @return Non-const pointer to the past-the-end position.
+    [[nodiscard]] iterator end() noexcept
+    {
+        return begin() + size();
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the SmallVector.
+    /// @return Const pointer to the past-the-end position.
+    [[nodiscard]] const_iterator cend() const noexcept
+    {
+        return cbegin() + size();
+    }
+
+    /// @brief Returns a reverse iterator pointing to the last element in the SmallVector.
+    [[nodiscard]] reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the last element in the SmallVector.
+    [[nodiscard]] const_reverse_iterator crbegin() const noexcept
+    {
+        return const_reverse_iterator(cend());
+    }
+
+    /// @brief Returns a reverse iterator pointing to the before the start element in the SmallVector.
+    [[nodiscard]] reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the before the start element in the SmallVector.
+    [[nodiscard]] const_reverse_iterator crend() const noexcept
+    {
+        return const_reverse_iterator(cbegin());
+    }
+
+    /// @brief Returns the non-const reference to the first element in the SmallVector.
+    /// @throws BoundedStackVectorUnderflow if the SmallVector is empty.
+    [[nodiscard]] reference front()
+    {
+        if (empty())
+        {
+            throw BoundedStackVectorUnderflow();
+        }
+        return *begin();
+    }
+
+    /// @brief Returns the const reference to the first element in the SmallVector.
+    /// @throws BoundedStackVectorUnderflow if the SmallVector is empty.
+    [[nodiscard]] const_reference front() const
+    {
+        if (empty())
+        {
+            throw BoundedStackVectorUnderflow();
+        }
+        return *cbegin();
+    }
+
+    /// @brief Returns the non-const reference to the last element in the SmallVector.
+    /// @throws BoundedStackVectorUnderflow if the SmallVector is empty.
+    [[nodiscard]] reference back()
+    {
+        if (empty())
+        {
+            throw BoundedStackVectorUnderflow();
+        }
+        return *(end() - 1);
+    }
+
+    /// @brief Returns the const reference to the last element in the SmallVector.
+    /// @throws BoundedStackVectorUnderflow if the SmallVector is empty.
+    [[nodiscard]] const_reference back() const
+    {
+        if (empty())
+        {
+            throw BoundedStackVectorUnderflow();
+        }
+        return *(cend() - 1);
+    }
+
+  private:
+    BoundedStackVector<T, N> inline_;
+    // Empty and without allocation until the SmallVector spills
+    std::vector<T> heap_;
+    bool on_heap_{false};
+
+    /// @brief Moves the inline elements to heap storage of the given capacity, at least N. The heap storage is built
+    /// aside and the inline elements are cleared only once it is complete, so an exception leaves the SmallVector
+    /// unchanged. Elements whose move constructor may throw are copied, as in std::vector, to keep them intact.
+    void spill(size_type capacity)
+    {
+        std::vector<T> heap;
+        heap.reserve(std::max(capacity, N));
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            heap.insert(heap.end(), std::make_move_iterator(inline_.begin()), std::make_move_iterator(inline_.end()));
+        }
+        else
+        {
+            heap.insert(heap.end(), inline_.begin(), inline_.end());
+        }
+        heap_.swap(heap);
+        inline_.clear();
+        on_heap_ = true;
+    }
+};
+} // namespace common_library::containers
+
+#endif // COMMON_LIBRARY_CONTAINERS_SMALL_VECTOR
@@ -1,10 +1,13 @@
-#include <algorithm>
+#ifndef COMMON_LIBRARY_CONTAINERS_STATIC_CONTAINER
+#define COMMON_LIBRARY_CONTAINERS_STATIC_CONTAINER
+
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 namespace common_library::containers
@@ -29,165 +32,188 @@ class StaticVectorReachedMaximumCapacityException : public std::length_error
     }
 };
 
+// Fixed-capacity vector holding all N elements in a plain array. Every member function is constexpr, so for a literal
+// type T a StaticContainer can be filled, iterated and copied during constant evaluation, and a table computed that way
+// is stored in the binary instead of being built at startup:
+//
+//     constexpr StaticContainer<int, 8> SQUARES = []() {
+//         StaticContainer<int, 8> squares;
+//         for (int i = 0; i < 8; ++i)
+//         {
+//             squares.push_back(i * i);
+//         }
+//         return squares;
+//     }();
+//
+// The N elements are value-initialized on construction, so T must be default constructible.
 template <typename T, std::size_t N> class StaticContainer
 {
     static_assert((N > 0), "Size of the StaticContainer must be greater than 0!");
 
   public:
-    class Iterator
+    template <typename Value> class BasicIterator
     {
       public:
         using difference_type = std::ptrdiff_t;
-        using value_type = T;
-        using pointer = T *;
-        using reference = T &;
+        using value_type = std::remove_const_t<Value>;
+        using pointer = Value *;
+        using reference = Value &;
         using iterator_category = std::random_access_iterator_tag;
 
-        explicit Iterator(T *data_ptr) noexcept : data_ptr_(data_ptr)
+        constexpr explicit BasicIterator(Value *data_ptr) noexcept : data_ptr_(data_ptr)
         {
         }
 
-        Iterator() = delete;
+        BasicIterator() = delete;
 
-        ~Iterator()
-        {
-            data_ptr_ = nullptr;
-        }
-
-        Iterator &operator++() noexcept
+        constexpr BasicIterator &operator++() noexcept
         {
             ++data_ptr_;
             return (*this);
         }
 
-        Iterator operator++(int) noexcept
+        constexpr BasicIterator operator++(int) noexcept
         {
-            Iterator data_ref_tmp = (*this);
+            BasicIterator data_ref_tmp = (*this);
             ++(*this);
             return data_ref_tmp;
         }
 
-        Iterator &operator--() noexcept
+        constexpr BasicIterator &operator--() noexcept
         {
             --data_ptr_;
             return (*this);
         }
 
-        Iterator operator--(int) noexcept
+        constexpr BasicIterator operator--(int) noexcept
         {
-            Iterator data_ref_tmp = (*this);
+            BasicIterator data_ref_tmp = (*this);
             --(*this);
             return data_ref_tmp;
         }
 
-        Iterator &operator+=(const difference_type data_ptr_diff) noexcept
+        constexpr BasicIterator &operator+=(const difference_type data_ptr_diff) noexcept
         {
             data_ptr_ += data_ptr_diff;
             return (*this);
         }
 
-        Iterator &operator-=(const difference_type data_ptr_diff) noexcept
+        constexpr BasicIterator &operator-=(const difference_type data_ptr_diff) noexcept
         {
             data_ptr_ -= data_ptr_diff;
             return (*this);
         }
 
-        difference_type operator-(const Iterator &other) noexcept
+        constexpr difference_type operator-(const BasicIterator &other) const noexcept
         {
             return (data_ptr_ - other.data_ptr_);
         }
 
-        Iterator operator+(const difference_type data_ptr_diff) noexcept
+        constexpr BasicIterator operator+(const difference_type data_ptr_diff) const noexcept
         {
-            return Iterator(data_ptr_ + data_ptr_diff);
+            return BasicIterator(data_ptr_ + data_ptr_diff);
         }
 
-        Iterator operator-(const difference_type data_ptr_diff) noexcept
+        constexpr BasicIterator operator-(const difference_type data_ptr_diff) const noexcept
         {
-            return Iterator(data_ptr_ - data_ptr_diff);
+            return BasicIterator(data_ptr_ - data_ptr_diff);
         }
 
-        T &operator[](const difference_type data_ptr_diff) noexcept
+        constexpr reference operator[](const difference_type data_ptr_diff) const noexcept
         {
             return (*(data_ptr_ + data_ptr_diff));
         }
 
-        const T &operator[](const difference_type data_ptr_diff) const noexcept
-        {
-            return (*(data_ptr_ + data_ptr_diff));
-        }
-
-        bool operator==(const Iterator &other) const noexcept
+        constexpr bool operator==(const BasicIterator &other) const noexcept
         {
             return (data_ptr_ == other.data_ptr_);
         }
 
-        bool operator!=(const Iterator &other) const noexcept
+        constexpr bool operator!=(const BasicIterator &other) const noexcept
         {
             return !((*this) == (other));
         }
 
-        T &operator*() const noexcept
+        constexpr reference operator*() const noexcept
         {
             return (*data_ptr_);
         }
 
       private:
-        T *data_ptr_;
+        Value *data_ptr_;
     };
 
+    using Iterator = BasicIterator<T>;
+    using ConstIterator = BasicIterator<const T>;
+
     // Default constructor
-    StaticContainer() : data_{}, size_{0U}
+    constexpr StaticContainer() : data_{}, size_{0U}
     {
     }
 
     // Copy constructor
-    StaticContainer(const StaticContainer &other) : size_{other.size_}
+    constexpr StaticContainer(const StaticContainer &other) : data_{}, size_{0U}
     {
-        std::copy(other.data_, other.data_ + other.size_, data_);
+        copyFrom(other);
     }
 
     // Copy assignment operator
-    StaticContainer &operator=(const StaticContainer &other)
+    constexpr StaticContainer &operator=(const StaticContainer &other)
     {
         if (this != (&other))
         {
-            size_ = other.size_;
-            std::copy(other.data_, other.data_ + other.size_, data_);
+            copyFrom(other);
         }
         return (*this);
     }
 
     // Move constructor
-    StaticContainer(StaticContainer &&other) noexcept : size_{other.size_}
+    constexpr StaticContainer(StaticContainer &&other) noexcept : data_{}, size_{0U}
     {
-        std::move(other.data_, other.data_ + other.size_, data_);
-        other.size_ = 0;
+        moveFrom(other);
     }
 
     // Move assignment operator
-    StaticContainer &operator=(StaticContainer &&other) noexcept
+    constexpr StaticContainer &operator=(StaticContainer &&other) noexcept
     {
         if (this != (&other))
         {
-            size_ = other.size_;
-            std::move(other.data_, other.data_ + other.size_, data_);
-            other.size_ = 0;
+            moveFrom(other);
         }
         return (*this);
     }
 
-    Iterator begin() noexcept
+    constexpr Iterator begin() noexcept
     {
         return Iterator(data_);
     }
 
-    Iterator end() noexcept
+    constexpr Iterator end() noexcept
     {
         return Iterator(data_ + size_);
     }
 
-    void pop_back() noexcept
+    constexpr ConstIterator begin() const noexcept
+    {
+        return ConstIterator(data_);
+    }
+
+    constexpr ConstIterator end() const noexcept
+    {
+        return ConstIterator(data_ + size_);
+    }
+
+    constexpr ConstIterator cbegin() const noexcept
+    {
+        return ConstIterator(data_);
+    }
+
+    constexpr ConstIterator cend() const noexcept
+    {
+        return ConstIterator(data_ + size_);
+    }
+
+    constexpr void pop_back() noexcept
     {
         if (size_ == 0U)
         {
@@ -196,7 +222,7 @@ template <typename T, std::size_t N> class StaticContainer
         --size_;
     }
 
-    void push_back(const T &value)
+    constexpr void push_back(const T &value)
     {
         if (size_ >= N)
         {
@@ -205,7 +231,7 @@ template <typename T, std::size_t N> class StaticContainer
         data_[size_++] = value;
     }
 
-    void resize(const std::size_t new_size)
+    constexpr void resize(const std::size_t new_size)
     {
         if (new_size > N)
         {
@@ -214,12 +240,17 @@ template <typename T, std::size_t N> class StaticContainer
         size_ = new_size;
     }
 
-    void reset() noexcept
+    constexpr void reset() noexcept
     {
         size_ = 0U;
     }
 
-    std::size_t size() const noexcept
+    constexpr bool empty() const noexcept
+    {
+        return (size_ == 0U);
+    }
+
+    constexpr std::size_t size() const noexcept
     {
         return size_;
     }
@@ -229,35 +260,35 @@ template <typename T, std::size_t N> class StaticContainer
         return N;
     }
 
-    T &operator[](const std::size_t index) noexcept
+    constexpr T &operator[](const std::size_t index) noexcept
     {
         return data_[index];
     }
 
-    const T &operator[](const std::size_t index) const noexcept
+    constexpr const T &operator[](const std::size_t index) const noexcept
     {
         return data_[index];
     }
 
-    T &at(const std::size_t index)
+    constexpr T &at(const std::size_t index)
     {
-        if ((index > N) || (size_ == 0))
+        if (index >= size_)
         {
             throw StaticVectorIndexOutOfRangeException();
         }
         return data_[index];
     }
 
-    const T &at(const std::size_t index) const
+    constexpr const T &at(const std::size_t index) const
     {
-        if ((index > N) || (size_ == 0))
+        if (index >= size_)
         {
             throw StaticVectorIndexOutOfRangeException();
         }
         return data_[index];
     }
 
-    T &front()
+    constexpr T &front()
     {
         if (size_ == 0U)
         {
@@ -266,7 +297,7 @@ template <typename T, std::size_t N> class StaticContainer
         return data_[0U];
     }
 
-    const T &front() const
+    constexpr const T &front() const
     {
         if (size_ == 0U)
         {
@@ -275,7 +306,7 @@ template <typename T, std::size_t N> class StaticContainer
         return data_[0U];
     }
 
-    T &back()
+    constexpr T &back()
     {
         if (size_ == 0U)
         {
@@ -284,7 +315,7 @@ template <typename T, std::size_t N> class StaticContainer
         return data_[size_ - 1];
     }
 
-    const T &back() const
+    constexpr const T &back() const
     {
         if (size_ == 0U)
         {
@@ -296,6 +327,28 @@ template <typename T, std::size_t N> class StaticContainer
   private:
     T data_[N];
     std::size_t size_;
+
+    // Element-wise loops, as std::copy and std::move are not constexpr before C++20
+    constexpr void copyFrom(const StaticContainer &other)
+    {
+        for (std::size_t i = 0U; i < other.size_; ++i)
+        {
+            data_[i] = other.data_[i];
+        }
+        size_ = other.size_;
+    }
+
+    constexpr void moveFrom(StaticContainer &other) noexcept
+    {
+        for (std::size_t i = 0U; i < other.size_; ++i)
+        {
+            data_[i] = std::move(other.data_[i]);
+        }
+        size_ = other.size_;
+        other.size_ = 0U;
+    }
 };
 
-} // namespace common_library::containers
\ No newline at end of file
+} // namespace common_library::containers
+
+#endif // COMMON_LIBRARY_CONTAINERS_STATIC_CONTAINER
\ No newline at end of file
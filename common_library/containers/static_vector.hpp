@@ -4,84 +4,146 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 namespace common_library::containers
 {
-template <typename T, std::size_t N> class StaticVector
+/// @brief Inline storage of StaticVector: raw bytes for N elements, of which only the first size_ hold live objects.
+/// Copies and moves construct only the live elements.
+template <typename T, std::size_t N, bool = std::is_trivially_copyable_v<T>> class StaticVectorStorage
 {
-    static_assert(N > 0, "Array of size 0 is not allowed.");
-
-  public:
-    using value_type = T;
-    using pointer = T *;
-    using const_pointer = const T *;
-    using reference = T &;
-    using const_reference = const T &;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
+  protected:
+    alignas(T) unsigned char bytes_[sizeof(T) * N];
+    std::size_t size_{0U};
 
-    /// @throws std::bad_alloc if not enough memory for allocation
-    constexpr StaticVector() : size_(0), data_(new T[N])
+    StaticVectorStorage() noexcept
     {
     }
 
-    /// @throws std::bad_alloc if not enough memory for allocation
-    constexpr explicit StaticVector(size_type size) : size_(size <= N ? size : N), data_(new T[N])
+    StaticVectorStorage(const StaticVectorStorage &other)
     {
+        std::uninitialized_copy_n(other.elements(), other.size_, elements());
+        size_ = other.size_;
     }
 
-    /// @throws std::bad_alloc if not enough memory for allocation
-    constexpr explicit StaticVector(size_type size, const_reference value)
-        : size_(size <= N ? size : N), data_(new T[N])
+    StaticVectorStorage(StaticVectorStorage &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
     {
-        for (auto &element : data_)
-        {
-            element = value;
-        }
+        std::uninitialized_move_n(other.elements(), other.size_, elements());
+        size_ = other.size_;
     }
 
-    /// @throws std::bad_alloc if not enough memory for allocation
-    StaticVector(const StaticVector &other) : size_(other.size_), data_(new T[other.size_])
+    StaticVectorStorage &operator=(const StaticVectorStorage &other)
     {
-        std::copy(other.data_, other.data_ + other.size_, data_);
+        if (this != &other)
+        {
+            assign(other.elements(), other.size_);
+        }
+        return *this;
     }
 
-    /// @throws std::bad_alloc if not enough memory for allocation
-    StaticVector &operator=(const StaticVector &other)
+    StaticVectorStorage &operator=(StaticVectorStorage &&other) noexcept(std::is_nothrow_move_assignable_v<T> &&
+                                                                       std::is_nothrow_move_constructible_v<T>)
     {
         if (this != &other)
         {
-            delete[] data_;
-            size_ = other.size_;
-            data_ = new T[N];
-            std::copy(other.data_, other.data_ + other.size_, data_);
+            assign(std::make_move_iterator(other.elements()), other.size_);
         }
         return *this;
     }
 
-    StaticVector(StaticVector &&other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
-        : size_(other.size_), data_(std::exchange(other.data_, nullptr))
+    ~StaticVectorStorage()
     {
+        std::destroy_n(elements(), size_);
     }
 
-    StaticVector &operator=(StaticVector &&other) noexcept(std::is_nothrow_move_assignable_v<value_type>)
+    T *elements() noexcept
     {
-        if (this != &other)
+        return std::launder(reinterpret_cast<T *>(bytes_));
+    }
+
+    const T *elements() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T *>(bytes_));
+    }
+
+  private:
+    // Assigns over the live elements both vectors have, then constructs or destroys the rest
+    template <typename Iterator> void assign(Iterator source, std::size_t count)
+    {
+        const std::size_t common = std::min(size_, count);
+        std::copy_n(source, common, elements());
+        if (count > size_)
         {
-            delete[] data_;
-            size_ = other.size_;
-            data_ = std::exchange(other.data_, nullptr);
+            std::uninitialized_copy_n(source + common, count - size_, elements() + size_);
         }
-        return *this;
+        else
+        {
+            std::destroy_n(elements() + count, size_ - count);
+        }
+        size_ = count;
     }
+};
 
-    ~StaticVector()
+/// @brief Storage for trivially copyable T: the implicit special members keep StaticVector trivially copyable, so a
+/// copy is a single fixed-size memcpy of the object
+template <typename T, std::size_t N> class StaticVectorStorage<T, N, true>
+{
+  protected:
+    alignas(T) unsigned char bytes_[sizeof(T) * N];
+    std::size_t size_{0U};
+
+    StaticVectorStorage() noexcept
     {
-        delete[] data_;
+    }
+
+    T *elements() noexcept
+    {
+        return std::launder(reinterpret_cast<T *>(bytes_));
+    }
+
+    const T *elements() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T *>(bytes_));
+    }
+};
+
+/// @brief Vector of at most N elements stored inside the object, without any heap allocation. Only the first size()
+/// elements are constructed. StaticVector is trivially copyable when T is.
+template <typename T, std::size_t N> class StaticVector : private StaticVectorStorage<T, N>
+{
+    static_assert(N > 0, "Array of size 0 is not allowed.");
+
+    using Storage = StaticVectorStorage<T, N>;
+    using Storage::elements;
+    using Storage::size_;
+
+  public:
+    using value_type = T;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using reference = T &;
+    using const_reference = const T &;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    StaticVector() noexcept = default;
+
+    /// @brief Constructs min(size, N) value-initialized elements
+    explicit StaticVector(size_type size)
+    {
+        resize(size <= N ? size : N);
+    }
+
+    /// @brief Constructs min(size, N) copies of the value
+    explicit StaticVector(size_type size, const_reference value)
+    {
+        std::uninitialized_fill_n(elements(), size <= N ? size : N, value);
+        size_ = (size <= N ? size : N);
     }
 
     template <typename Pointer, typename Reference> class RandomAccessIterator
@@ -137,16 +199,16 @@ template <typename T, std::size_t N> class StaticVector
         /// @throws std::runtime_error if accessing an element outside of bounds
         inline RandomAccessIterator operator+(difference_type n) const
         {
-            if (n >= N)
+            if (n >= static_cast<difference_type>(N))
             {
                 throw std::runtime_error("Attempting to access an element outside of bounds.");
             }
             return RandomAccessIterator(ptr_ + n);
         }
         /// @throws std::runtime_error if accessing an element outside of bounds
-        inline RandomAccessIterator operator-(difference_type n) const noexcept
+        inline RandomAccessIterator operator-(difference_type n) const
         {
-            if (n >= N)
+            if (n >= static_cast<difference_type>(N))
             {
                 throw std::runtime_error("Attempting to access an element outside of bounds.");
             }
@@ -192,21 +254,29 @@ template <typename T, std::size_t N> class StaticVector
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-    inline iterator begin() const noexcept
+    inline iterator begin() noexcept
     {
-        return iterator(data_);
+        return iterator(elements());
     }
-    inline iterator end() const noexcept
+    inline iterator end() noexcept
     {
-        return iterator(data_ + size_);
+        return iterator(elements() + size_);
+    }
+    inline const_iterator begin() const noexcept
+    {
+        return const_iterator(elements());
+    }
+    inline const_iterator end() const noexcept
+    {
+        return const_iterator(elements() + size_);
     }
     inline const_iterator cbegin() const noexcept
     {
-        return const_iterator(data_);
+        return const_iterator(elements());
     }
     inline const_iterator cend() const noexcept
     {
-        return const_iterator(data_ + size_);
+        return const_iterator(elements() + size_);
     }
     inline reverse_iterator rbegin() noexcept
     {
@@ -245,12 +315,21 @@ template <typename T, std::size_t N> class StaticVector
     {
         return N;
     }
-    /// @throws std::bad_alloc if the new size is larger than allocated capacity
+    /// @brief Value-initializes the elements added, destroys the elements removed
+    /// @throws std::length_error if the new size is larger than the capacity
     void resize(size_type new_size)
     {
-        if (new_size >= N)
+        if (new_size > N)
         {
-            throw std::bad_alloc("The new size is larger than allocated capacity.");
+            throw std::length_error("The new size is larger than the capacity of the static vector.");
+        }
+        if (new_size > size_)
+        {
+            std::uninitialized_value_construct_n(elements() + size_, new_size - size_);
+        }
+        else
+        {
+            std::destroy_n(elements() + new_size, size_ - new_size);
         }
         size_ = new_size;
     }
@@ -261,7 +340,7 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("Attempting to access an element outside of bounds.");
         }
-        return data_[index];
+        return elements()[index];
     }
     /// @throws std::runtime_error if accessing an element outside of bounds
     const_reference at(size_type index) const
@@ -270,15 +349,15 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("Attempting to access an element outside of bounds.");
         }
-        return data_[index];
+        return elements()[index];
     }
     inline reference operator[](size_type index) noexcept
     {
-        return data_[index];
+        return elements()[index];
     }
     inline const_reference operator[](size_type index) const noexcept
     {
-        return data_[index];
+        return elements()[index];
     }
     /// @throws std::runtime_error if the data is empty
     reference front()
@@ -287,7 +366,7 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("There are no elements in the static vector.");
         }
-        return data_[0];
+        return elements()[0];
     }
     /// @throws std::runtime_error if the data is empty
     const_reference front() const
@@ -296,7 +375,7 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("There are no elements in the static vector.");
         }
-        return data_[0];
+        return elements()[0];
     }
     /// @throws std::runtime_error if the data is empty
     reference back()
@@ -305,7 +384,7 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("There are no elements in the static vector.");
         }
-        return data_[size - 1U];
+        return elements()[size_ - 1U];
     }
     /// @throws std::runtime_error if the data is empty
     const_reference back() const
@@ -314,63 +393,63 @@ template <typename T, std::size_t N> class StaticVector
         {
             throw std::runtime_error("There are no elements in the static vector.");
         }
-        return data_[size - 1U];
+        return elements()[size_ - 1U];
     }
     inline pointer data() noexcept
     {
-        return data_;
+        return elements();
     }
     inline const_pointer data() const noexcept
     {
-        return data_;
+        return elements();
     }
+    /// @brief Constructs the element in place at the end
     /// @throws std::runtime_error if no more elements are allowed to be added
-    template <typename... Args> void emplace_back(Args &&...args)
+    template <typename... Args> reference emplace_back(Args &&...args)
     {
         if (size_ >= N)
         {
             throw std::runtime_error("Static vector reached maximum capacity.");
         }
-        data_[size_++] = T(std::forward<Args>(args)...);
+        T *element = ::new (static_cast<void *>(elements() + size_)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *element;
     }
     /// @throws std::runtime_error if no more elements are allowed to be added
     void push_back(const value_type &value)
     {
-        if (size_ >= N)
-        {
-            throw std::runtime_error("Static vector reached maximum capacity.");
-        }
-        data_[size_++] = value;
+        emplace_back(value);
     }
     /// @throws std::runtime_error if no more elements are allowed to be added
     void push_back(value_type &&value)
     {
-        if (size_ >= N)
-        {
-            throw std::runtime_error("Static vector reached maximum capacity.");
-        }
-        data_[size_++] = std::move(value);
+        emplace_back(std::move(value));
     }
     void pop_back()
     {
         if (size_ > 0U)
         {
             --size_;
+            std::destroy_at(elements() + size_);
         }
     }
     inline void clear() noexcept
     {
+        std::destroy_n(elements(), size_);
         size_ = 0U;
     }
-    void swap(StaticVector &other) noexcept(std::is_nothrow_swappable_v<value_type>)
+    void swap(StaticVector &other) noexcept(std::is_nothrow_swappable_v<value_type> &&
+                                            std::is_nothrow_move_constructible_v<value_type>)
     {
-        std::swap(data_, other.data_);
+        StaticVector &shorter = (size_ <= other.size_) ? *this : other;
+        StaticVector &longer = (size_ <= other.size_) ? other : *this;
+        std::swap_ranges(shorter.elements(), shorter.elements() + shorter.size_, longer.elements());
+        // Move the tail of the longer vector into the shorter one
+        std::uninitialized_move(longer.elements() + shorter.size_, longer.elements() + longer.size_,
+                                shorter.elements() + shorter.size_);
+        std::destroy(longer.elements() + shorter.size_, longer.elements() + longer.size_);
         std::swap(size_, other.size_);
     }
-
-  private:
-    std::size_t size_;
-    T *data_;
 };
 
 template <typename T, std::size_t N> constexpr bool operator==(const StaticVector<T, N> &a, const StaticVector<T, N> &b)
@@ -411,4 +490,4 @@ template <typename T, std::size_t N> void swap(StaticVector<T, N> &a, StaticVect
 }
 } // namespace common_library::containers
 
-#endif
\ No newline at end of file
+#endif
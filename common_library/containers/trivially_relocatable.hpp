@@ -0,0 +1,26 @@
+#ifndef COMMON_LIBRARY_CONTAINERS_TRIVIALLY_RELOCATABLE
+#define COMMON_LIBRARY_CONTAINERS_TRIVIALLY_RELOCATABLE
+
+#include <type_traits>
+
+namespace common_library::containers
+{
+/// @brief Whether an object of type T can be moved to another address by copying its bytes, after which the source is
+/// treated as raw memory and its destructor is not run. Containers use it to shift elements with memmove.
+///
+/// True for trivially copyable types. Other types opt in by specializing the trait, which is correct for types that
+/// neither point into themselves nor are registered by address elsewhere, e.g. a class holding a std::unique_ptr:
+///
+///     template <> struct common_library::containers::is_trivially_relocatable<Order> : std::true_type
+///     {
+///     };
+///
+/// Do not opt in types holding a std::string or std::list of libstdc++, which point into themselves.
+template <typename T> struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{
+};
+
+template <typename T> inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+} // namespace common_library::containers
+
+#endif // COMMON_LIBRARY_CONTAINERS_TRIVIALLY_RELOCATABLE
@@ -35,11 +35,10 @@ void produce(LockFreeQueueSharedPtr queue)
     number_of_active_producers.fetch_sub(1);
     if (number_of_active_producers.load() == 0)
     {
-        for (int i = 0; i < NUM_CONSUMERS; ++i)
-        {
-            queue->push(TERMINATION_TOKEN);
-            logger.log("Producer thread ", std::this_thread::get_id(), " Termination token: ", TERMINATION_TOKEN);
-        }
+        // One token per consumer, pushed as a batch
+        const std::vector<int> termination_tokens(NUM_CONSUMERS, TERMINATION_TOKEN);
+        queue->pushRange(termination_tokens.begin(), termination_tokens.end());
+        logger.log("Producer thread ", std::this_thread::get_id(), " Termination tokens: ", NUM_CONSUMERS);
     }
 }
 
@@ -49,7 +48,8 @@ void consume(LockFreeQueueSharedPtr queue)
 
     while (true)
     {
-        if (queue->tryPop(val))
+        // Wake up at least every 10 ms even if the queue stays empty, e.g. for housekeeping
+        if (queue->popFor(val, std::chrono::milliseconds(10)))
         {
             // Check for termination token.
             if (val == TERMINATION_TOKEN)
@@ -64,10 +64,61 @@ void consume(LockFreeQueueSharedPtr queue)
     }
 }
 
+// Closes the queue while a producer is pushing: the single consumer must still take every item that was pushed
+bool closeDuringPush()
+{
+    for (int round = 0; round < 1000; ++round)
+    {
+        common_library::concurrency::BoundedSharedQueue<int> queue(4U);
+        int pushed = 0;
+        int popped = 0;
+
+        std::thread producer([&queue, &pushed]() {
+            try
+            {
+                while (true)
+                {
+                    queue.push(pushed);
+                    ++pushed;
+                }
+            }
+            catch (const common_library::concurrency::BoundedSharedQueueShutdownException &)
+            {
+            }
+        });
+        std::thread consumer([&queue, &popped]() {
+            try
+            {
+                while (true)
+                {
+                    static_cast<void>(queue.pop());
+                    ++popped;
+                }
+            }
+            catch (const common_library::concurrency::BoundedSharedQueueShutdownException &)
+            {
+            }
+        });
+
+        std::this_thread::sleep_for(std::chrono::microseconds(round % 50));
+        queue.close();
+        queue.waitUntilDrained();
+        producer.join();
+        consumer.join();
+
+        if (pushed != popped)
+        {
+            logger.log("Round ", round, ": pushed ", pushed, " items, popped ", popped);
+            return false;
+        }
+    }
+    return true;
+}
+
 int main()
 {
-    auto queue =
-        std::make_shared<common_library::concurrency::BoundedSharedQueue<int>>(std::numeric_limits<std::size_t>::max());
+    // The queue preallocates its slots, so it is sized for the expected backlog rather than without limit
+    auto queue = std::make_shared<common_library::concurrency::BoundedSharedQueue<int>>(1024U);
 
     // Start a producer thread and multiple consumer threads.
     std::vector<std::thread> producer_threads;
@@ -93,11 +144,22 @@ int main()
         producer_thread.join();
     }
 
+    // Reject further pushes and wait until the consumers have taken everything that was queued
+    queue->close();
+    queue->waitUntilDrained();
+    logger.log("Queue drained");
+
     for (auto &consumer_thread : consumer_threads)
     {
         logger.log("Consumer thread ", consumer_thread.get_id(), " is joining");
         consumer_thread.join();
     }
 
+    if (!closeDuringPush())
+    {
+        return 1;
+    }
+    logger.log("Every item pushed before close() was popped");
+
     return 0;
 }
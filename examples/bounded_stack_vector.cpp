@@ -1,5 +1,20 @@
 #include <common_library/containers/bounded_stack_vector.hpp>
 
+#include <memory>
+#include <string>
+
+// Holds its details behind a std::unique_ptr, which may be moved to another address with memcpy
+struct Order
+{
+    std::unique_ptr<int> details;
+    double price{0.0};
+};
+
+// Lets BoundedStackVector shift Orders with a single memmove in insert, emplace and erase
+template <> struct common_library::containers::is_trivially_relocatable<Order> : std::true_type
+{
+};
+
 int main()
 {
     common_library::containers::BoundedStackVector<int, 10> vec;
@@ -70,8 +85,25 @@ int main()
     std::cout << vec2.front() << std::endl;
     std::cout << vec2.back() << std::endl;
 
-    common_library::containers::BoundedStackVector<int, 1'000'000'000> vec3;
-    std::cout << "Size of the vector: " << vec3.max_size() << std::endl;
+    common_library::containers::BoundedStackVector<Order, 8> orders;
+    orders.push_back(Order{std::make_unique<int>(2), 101.5});
+    orders.push_back(Order{std::make_unique<int>(3), 101.0});
+    orders.insert(orders.begin(), Order{std::make_unique<int>(1), 102.0});
+    for (const auto &order : orders)
+    {
+        std::cout << *order.details << ": " << order.price << " ";
+    }
+    std::cout << std::endl;
+
+    // Only the elements in use are constructed: creating a vector of 4096 strings constructs none of them
+    common_library::containers::BoundedStackVector<std::string, 4096> names;
+    names.emplace_back("first");
+    names.emplace_back(3, 'x');
+    std::cout << names.front() << " " << names.back() << " " << names.size() << std::endl;
+
+    // The storage for all N elements is part of the object, so a large vector must stay well below the stack size
+    common_library::containers::BoundedStackVector<int, 100'000> vec3;
+    std::cout << "Size of the vector: " << vec3.max_size() << ", " << sizeof(vec3) << " bytes" << std::endl;
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <common_library/concurrency/bounded_shared_queue.hpp>
+#include <common_library/concurrency/inplace_function.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Task = common_library::concurrency::InplaceFunction<void()>;
+
+constexpr int NUM_WORKERS = 3;
+constexpr int NUM_TASKS = 12;
+
+int main()
+{
+    // The tasks live inside the queue's preallocated slots: submitting one does not allocate
+    common_library::concurrency::BoundedSharedQueue<Task> queue{64U};
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < NUM_WORKERS; ++w)
+    {
+        workers.emplace_back([&queue]() {
+            try
+            {
+                for (;;)
+                {
+                    queue.pop()();
+                }
+            }
+            catch (const common_library::concurrency::BoundedSharedQueueShutdownException &)
+            {
+                // Closed and drained
+            }
+        });
+    }
+
+    for (int i = 0; i < NUM_TASKS; ++i)
+    {
+        // Move-only captures are fine, since tasks are moved rather than copied into the queue
+        auto payload = std::make_unique<std::string>("task " + std::to_string(i));
+        queue.push([payload = std::move(payload)]() { std::cout << *payload + " done\n" << std::flush; });
+    }
+
+    // A callable larger than the inline storage would not compile:
+    //     char buffer[128]{};
+    //     queue.push([buffer]() {});
+    // A larger capacity has to be chosen explicitly, e.g. InplaceFunction<void(), 192>.
+
+    queue.close();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    return 0;
+}
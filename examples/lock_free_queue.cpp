@@ -48,24 +48,18 @@ void consume(LockFreeQueueSharedPtr queue)
 {
     while (true)
     {
-        auto val = queue->pop();
-
-        if (val == nullptr)
-        {
-            // If we received a nullptr, sleep for a bit to backoff
-            // std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
-        }
+        // Blocks until a value is available, sleeping instead of spinning while the queue is empty
+        const int val = queue->wait_pop();
 
         // Check for termination token.
-        if (*val == TERMINATION_TOKEN)
+        if (val == TERMINATION_TOKEN)
         {
             break;
         }
 
         // Note that due to thread scheduling, the logging might happen with some offset
         // causing values to be printed out-of-order, despite logger being thread safe
-        logger.log("Consumer thread: ", std::this_thread::get_id(), " Value: ", *val);
+        logger.log("Consumer thread: ", std::this_thread::get_id(), " Value: ", val);
     }
 }
 
@@ -103,5 +97,9 @@ int main()
         consumer_thread.join();
     }
 
+    const auto statistics = common_library::concurrency::LockFreeQueue<int>::nodePoolStatistics();
+    logger.log("Node pool global allocations: ", statistics.global_allocations,
+               ", depot refills: ", statistics.depot_refills, ", depot spills: ", statistics.depot_spills);
+
     return 0;
 }
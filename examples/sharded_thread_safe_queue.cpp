@@ -0,0 +1,69 @@
+#include <common_library/concurrency/sharded_thread_safe_queue.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr int NUM_PRODUCERS = 4;
+constexpr int NUM_CONSUMERS = 4;
+constexpr int NUM_VALUES_PER_PRODUCER = 10'000;
+
+int main()
+{
+    common_library::concurrency::ShardedThreadSafeQueue<int> queue{4U};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < NUM_PRODUCERS; ++p)
+    {
+        producers.emplace_back([&queue]() {
+            for (int i = 0; i < NUM_VALUES_PER_PRODUCER; ++i)
+            {
+                // Each producer fills its own shard
+                queue.push(i);
+            }
+        });
+    }
+
+    std::atomic<long> sum{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < NUM_CONSUMERS; ++c)
+    {
+        consumers.emplace_back([&queue, &sum]() {
+            // Takes from its own shard first, then steals from the others, until the queue is closed and empty
+            while (const std::optional<int> value = queue.pop())
+            {
+                sum.fetch_add(*value, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    queue.close();
+    for (auto &consumer : consumers)
+    {
+        consumer.join();
+    }
+
+    const long expected =
+        static_cast<long>(NUM_PRODUCERS) * NUM_VALUES_PER_PRODUCER * (NUM_VALUES_PER_PRODUCER - 1) / 2;
+    std::cout << "Sum of popped values: " << sum.load() << ", expected: " << expected << std::endl;
+
+    // Values pushed with the same key go to the same shard, so a single consumer sees them in order
+    common_library::concurrency::ShardedThreadSafeQueue<std::string> ordered_queue{4U};
+    const std::string session = "session-42";
+    ordered_queue.push(session, std::string("connect"));
+    ordered_queue.push(session, std::string("send"));
+    ordered_queue.push(session, std::string("disconnect"));
+    ordered_queue.close();
+    while (const std::optional<std::string> event = ordered_queue.pop())
+    {
+        std::cout << session << ": " << *event << std::endl;
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <thread>
 
 constexpr std::size_t QUEUE_SIZE = 100;
@@ -35,6 +37,120 @@ void consumer(common_library::concurrency::SingleProducerSingleConsumerQueue<int
     std::cout << "Elapsed SPSCQueue consumer time [ns]: " << (t2 - t1).count() / 1e9 << std::endl;
 }
 
+// Zero-copy API: elements are filled and read in place inside the ring buffer
+void zeroCopy()
+{
+    common_library::concurrency::SingleProducerSingleConsumerQueue<std::string> queue(8);
+
+    // A reserved slot is not visible to the consumer before commit(), and a push abandons it
+    std::string *reserved = queue.try_reserve();
+    *reserved = "abandoned";
+    std::cout << "Peek after an uncommitted reserve: " << ((queue.peek() == nullptr) ? "empty" : *queue.peek()) << "\n";
+    if (queue.emplace("pushed"))
+    {
+        std::cout << "Peek after a push: " << *queue.peek() << "\n";
+        queue.release();
+    }
+
+    // Move both indices to slot 6, two slots before the end of the ring buffer
+    std::string value;
+    for (int i = 0; i < 5; ++i)
+    {
+        if (!queue.emplace("filler") || !queue.pop(value))
+        {
+            return;
+        }
+    }
+
+    // A span never wraps around the end of the ring buffer: the remaining slots are reserved from its start
+    int written = 0;
+    for (std::size_t remaining = 5U; remaining > 0U;)
+    {
+        const auto span = queue.try_reserve(remaining);
+        if (span.empty())
+        {
+            return;
+        }
+        std::cout << "Reserved " << span.size << " contiguous slots\n";
+        for (auto &slot : span)
+        {
+            slot = "message " + std::to_string(written++);
+        }
+        queue.commit(span.size);
+        remaining -= span.size;
+    }
+
+    // peek(n) after a partial release starts at the first element not released yet
+    auto peeked = queue.peek(5U);
+    std::cout << "Peeked " << peeked.size << " elements, releasing " << peeked[0] << "\n";
+    queue.release(1U);
+    for (peeked = queue.peek(5U); !peeked.empty(); peeked = queue.peek(5U))
+    {
+        std::cout << "Peeked " << peeked.size << " elements:";
+        for (const auto &element : peeked)
+        {
+            std::cout << " [" << element << "]";
+        }
+        std::cout << "\n";
+        queue.release(peeked.size);
+    }
+
+    // Reserved slots that are never committed are destroyed with the queue
+    reserved = queue.try_reserve();
+    *reserved = "never committed";
+}
+
+// Neither default constructible nor copyable nor movable, counts its live instances
+struct Payload
+{
+    static inline int instances = 0;
+    int id;
+
+    explicit Payload(int payload_id) : id(payload_id)
+    {
+        ++instances;
+    }
+
+    Payload(const Payload &other) = delete;
+    Payload &operator=(const Payload &other) = delete;
+
+    ~Payload()
+    {
+        --instances;
+    }
+};
+
+// Move-only elements, and elements constructed in place that are never moved
+void moveOnly()
+{
+    {
+        common_library::concurrency::SingleProducerSingleConsumerQueue<std::unique_ptr<Payload>> pointers(4);
+        for (int id = 0; id < 3; ++id)
+        {
+            if (!pointers.emplace(std::make_unique<Payload>(id)))
+            {
+                return;
+            }
+        }
+        std::unique_ptr<Payload> popped;
+        if (pointers.pop(popped))
+        {
+            std::cout << "Popped payload " << popped->id << ", live payloads: " << Payload::instances << "\n";
+        }
+
+        // emplace() forwards the arguments to the constructor; peek() and release() consume without moving
+        common_library::concurrency::SingleProducerSingleConsumerQueue<Payload> payloads(4);
+        if (payloads.emplace(10) && payloads.emplace(11))
+        {
+            std::cout << "Peeked payload " << payloads.peek()->id << "\n";
+            payloads.release();
+        }
+        std::cout << "Live payloads before the queues are destroyed: " << Payload::instances << "\n";
+    }
+    // The elements still queued are destroyed with their queue
+    std::cout << "Live payloads after the queues are destroyed: " << Payload::instances << "\n";
+}
+
 int main()
 {
     common_library::concurrency::SingleProducerSingleConsumerQueue<int> queue(QUEUE_SIZE);
@@ -45,5 +161,8 @@ int main()
     producer_thread.join();
     consumer_thread.join();
 
+    zeroCopy();
+    moveOnly();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include <common_library/containers/small_vector.hpp>
+
+#include <iostream>
+#include <string>
+
+int main()
+{
+    common_library::containers::SmallVector<std::string, 4> words;
+
+    // Up to four words are stored inline, without allocating
+    for (const char *word : {"one", "two", "three", "four"})
+    {
+        words.emplace_back(word);
+    }
+    std::cout << "Size: " << words.size() << ", inline: " << std::boolalpha << words.is_inline() << std::endl;
+
+    // The fifth word spills all of them to the heap instead of throwing
+    words.emplace_back("five");
+    std::cout << "Size: " << words.size() << ", inline: " << words.is_inline() << ", capacity: " << words.capacity()
+              << std::endl;
+
+    words.insert(words.begin(), "zero");
+    (void)words.erase(words.begin() + 2);
+
+    for (const auto &word : words)
+    {
+        std::cout << word << " ";
+    }
+    std::cout << std::endl;
+
+    common_library::containers::SmallVector<int, 8> numbers{1, 2, 3};
+    numbers.pop_back();
+    std::cout << "Front: " << numbers.front() << ", back: " << numbers.back() << std::endl;
+
+    try
+    {
+        std::cout << numbers.at(5) << std::endl;
+    }
+    catch (const common_library::containers::BoundedStackVectorInvalidIndexAccess &ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+
+    return 0;
+}
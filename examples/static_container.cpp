@@ -1,5 +1,6 @@
 #include <common_library/containers/static_container.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <ostream>
 #include <random>
@@ -28,10 +29,42 @@ struct Plane
     }
 };
 
+// Lookup table computed during compilation and stored in the binary, with no work left for startup
+constexpr auto PRIMES = []() {
+    common_library::containers::StaticContainer<int, 16> primes;
+    for (int candidate = 2; primes.size() < primes.max_size(); ++candidate)
+    {
+        bool is_prime = true;
+        for (const int prime : primes)
+        {
+            if (candidate % prime == 0)
+            {
+                is_prime = false;
+                break;
+            }
+        }
+        if (is_prime)
+        {
+            primes.push_back(candidate);
+        }
+    }
+    return primes;
+}();
+
+static_assert(PRIMES.front() == 2 && PRIMES.back() == 53, "PRIMES holds the first 16 primes");
+static_assert(*std::max_element(PRIMES.begin(), PRIMES.end()) == 53, "Algorithms run on PRIMES at compile time");
+
 int main()
 {
     using namespace common_library::containers;
 
+    std::cout << "Primes:";
+    for (const int prime : PRIMES)
+    {
+        std::cout << " " << prime;
+    }
+    std::cout << std::endl;
+
     StaticContainer<Plane, 100> planes;
     std::cout << *(planes.begin() + 10) << std::endl;
 
@@ -1,6 +1,7 @@
 #include "common_library/containers/static_vector.hpp"
 
 #include <iostream>
+#include <type_traits>
 
 class NonTrivialType
 {
@@ -147,5 +148,12 @@ int main()
         vec.pop_back();
     }
 
+    // The elements live inside the object, so a vector of trivially copyable values is itself trivially copyable and
+    // can be copied with memcpy, e.g. into a message buffer
+    static_assert(std::is_trivially_copyable_v<common_library::containers::StaticVector<int, 16>>);
+    common_library::containers::StaticVector<int, 16> values(4, 7);
+    const auto copy = values;
+    std::cout << "Copied " << copy.size() << " values, size of the vector: " << sizeof(copy) << " bytes" << std::endl;
+
     return 0;
 }
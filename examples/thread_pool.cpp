@@ -0,0 +1,74 @@
+#include <common_library/concurrency/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using common_library::concurrency::TaskFuture;
+using common_library::concurrency::ThreadPool;
+
+// Tasks may submit subtasks and wait for them: a waiting worker runs other tasks instead of blocking
+std::uint64_t fibonacci(ThreadPool &pool, int n)
+{
+    if (n < 20)
+    {
+        return (n < 2) ? static_cast<std::uint64_t>(n) : fibonacci(pool, n - 1) + fibonacci(pool, n - 2);
+    }
+    TaskFuture<std::uint64_t> first = pool.submit([&pool, n]() { return fibonacci(pool, n - 1); });
+    const std::uint64_t second = fibonacci(pool, n - 2);
+    return first.get() + second;
+}
+
+int main()
+{
+    ThreadPool pool{4U};
+
+    // Independent tasks with results
+    std::vector<TaskFuture<int>> squares;
+    for (int i = 0; i < 10; ++i)
+    {
+        squares.push_back(pool.submit([i]() { return i * i; }));
+    }
+    int sum_of_squares = 0;
+    for (auto &square : squares)
+    {
+        sum_of_squares += square.get();
+    }
+    std::cout << "Sum of squares: " << sum_of_squares << std::endl;
+
+    // Exceptions thrown by a task are rethrown by get()
+    TaskFuture<void> failing = pool.submit([]() { throw std::runtime_error("task failed"); });
+    try
+    {
+        failing.get();
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "Caught: " << error.what() << std::endl;
+    }
+
+    // Loop over an index range, split into parts that idle workers steal
+    std::vector<std::uint64_t> values(1'000'000);
+    pool.parallelFor(std::size_t{0}, values.size(), [&values](std::size_t i) { values[i] = i * 2U; });
+
+    std::atomic<std::uint64_t> sum{0};
+    pool.parallelFor(
+        std::size_t{0}, values.size(),
+        [&values, &sum](std::size_t i) { sum.fetch_add(values[i], std::memory_order_relaxed); }, std::size_t{4096});
+    std::cout << "Sum of values: " << sum.load() << std::endl;
+
+    std::cout << "Fibonacci(30): " << fibonacci(pool, 30) << std::endl;
+
+    // The destructor of a pool runs the queued tasks, so their futures can still be read after it is gone
+    TaskFuture<int> outliving;
+    {
+        auto short_lived = std::make_unique<ThreadPool>(2U);
+        outliving = short_lived->submit([]() { return 42; });
+    }
+    std::cout << "Result after the pool is destroyed: " << outliving.get() << std::endl;
+
+    return 0;
+}
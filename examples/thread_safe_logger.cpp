@@ -0,0 +1,105 @@
+#include <common_library/concurrency/binary_log.hpp>
+#include <common_library/concurrency/log_sink.hpp>
+#include <common_library/concurrency/thread_safe_logger.hpp>
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+constexpr int NUM_THREADS = 4;
+constexpr int NUM_MESSAGES_PER_THREAD = 5;
+
+void logMessages(common_library::concurrency::ThreadSafeLogger &logger, int thread_index)
+{
+    for (int i = 0; i < NUM_MESSAGES_PER_THREAD; ++i)
+    {
+        logger.log("Thread ", thread_index, " (", std::this_thread::get_id(), ") message ", i, " value ", i * 0.5);
+    }
+}
+
+void logFromThreads(common_library::concurrency::ThreadSafeLogger &logger)
+{
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < NUM_THREADS; ++thread_index)
+    {
+        threads.emplace_back(logMessages, std::ref(logger), thread_index);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+int main()
+{
+    auto &logger = common_library::concurrency::ThreadSafeLogger::getInstance(10'000);
+
+    // Text output to the standard output
+    logFromThreads(logger);
+
+    // Messages below the runtime threshold are discarded without evaluating the arguments of the macros
+    int evaluations = 0;
+    logger.setLevel(common_library::concurrency::LogLevel::WARNING);
+    COMMON_LIBRARY_LOG_INFO(logger, "Not logged, evaluated ", ++evaluations, " times");
+    COMMON_LIBRARY_LOG_WARNING(logger, "Logged, evaluated ", ++evaluations, " times");
+    COMMON_LIBRARY_LOG_ERROR(logger, "Logged, evaluated ", ++evaluations, " times");
+    logger.setLevel(common_library::concurrency::LogLevel::INFO);
+
+    // A burst larger than the buffer: if the worker falls behind, the oldest messages are discarded and reported in a
+    // single WARNING line
+    logger.setOverflowPolicy(common_library::concurrency::LogOverflowPolicy::DROP_OLDEST);
+    for (int i = 0; i < 20'000; ++i)
+    {
+        logger.log("Burst message ", i);
+    }
+    logger.flush();
+    std::cout << "Dropped messages: " << logger.droppedMessages() << std::endl;
+    logger.setOverflowPolicy(common_library::concurrency::LogOverflowPolicy::DROP_NEWEST);
+
+    // Binary output to a memory-mapped file instead of the standard output, decoded back to text below
+    const std::string path = "thread_safe_logger_example.blog";
+    auto binary_sink = std::make_shared<common_library::concurrency::BinaryLogSink>(path, 1024U * 1024U, 2U);
+    logger.setSinks({binary_sink});
+    logFromThreads(logger);
+
+    // Wait until the worker has written the messages, then close the file
+    logger.flush();
+    logger.setSinks({std::make_shared<common_library::concurrency::StandardOutputLogSink>()});
+    binary_sink.reset();
+
+    std::cout << "Decoded binary log:" << std::endl;
+    common_library::concurrency::BinaryLogReader reader{path};
+    common_library::concurrency::BinaryLogReader::Message message;
+    while (reader.next(message))
+    {
+        std::cout << message.unix_nanoseconds << " [" << message.thread_id << "] ["
+                  << common_library::concurrency::logLevelName(message.level) << "] " << message.text << std::endl;
+    }
+    std::remove(path.c_str());
+
+    // A separate logger, e.g. for one subsystem, with its own level. It keeps its recent messages in memory for a
+    // crash dump, and writes to the standard output from a thread of its own so that a slow terminal cannot hold back
+    // the memory sink.
+    {
+        common_library::concurrency::ThreadSafeLogger subsystem_logger{1'000};
+        subsystem_logger.setLevel(common_library::concurrency::LogLevel::DEBUG);
+        auto memory_sink = std::make_shared<common_library::concurrency::MemoryLogSink>(256U);
+        subsystem_logger.setSinks({std::make_shared<common_library::concurrency::AsyncLogSink>(
+            std::make_unique<common_library::concurrency::StandardOutputLogSink>(), 1'024U)});
+        subsystem_logger.addSink(memory_sink);
+        for (int i = 0; i < 10; ++i)
+        {
+            subsystem_logger.log(common_library::concurrency::LogLevel::DEBUG, "Subsystem step ", i);
+        }
+        subsystem_logger.flush();
+        std::cout << "Last messages of the subsystem:" << std::endl;
+        memory_sink->dump(STDOUT_FILENO);
+    }
+
+    return 0;
+}
@@ -11,6 +11,9 @@ void producer()
     {
         queue.push(i);
     }
+
+    // No more values: the consumer still receives the queued ones, then pop() returns an empty optional
+    queue.close();
 }
 
 void consumer()
@@ -18,13 +21,8 @@ void consumer()
     auto t1 = std::chrono::steady_clock::now();
 
     auto &queue = common_library::concurrency::ThreadSafeQueue<int>::getInstance();
-    for (int i = 0; i < 100; ++i)
+    while (const std::optional<int> value = queue.pop())
     {
-        std::optional<int> value;
-        do
-        {
-            value = queue.pop();
-        } while (!value);
         std::cout << "Popped " << *value << " from the queue.\n";
     }
 
@@ -38,6 +36,7 @@ int main()
     std::thread consumer_thread(&consumer);
 
     producer_thread.join();
+    common_library::concurrency::ThreadSafeQueue<int>::getInstance().waitUntilDrained();
     consumer_thread.join();
 
     return 0;
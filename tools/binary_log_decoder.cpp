@@ -0,0 +1,46 @@
+#include <common_library/concurrency/binary_log.hpp>
+
+#include <cstdint>
+#include <ctime>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+
+// Prints binary log files written by BinaryLogSink as text, one message per line:
+//     2024-01-31 12:34:56.123456789 [thread id] [LEVEL] message
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <binary log file>..." << std::endl;
+        return 1;
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        try
+        {
+            common_library::concurrency::BinaryLogReader reader{argv[i]};
+            common_library::concurrency::BinaryLogReader::Message message;
+            while (reader.next(message))
+            {
+                constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+                const std::time_t seconds = message.unix_nanoseconds / NANOSECONDS_PER_SECOND;
+                const std::int64_t nanoseconds = message.unix_nanoseconds % NANOSECONDS_PER_SECOND;
+
+                std::tm time{};
+                gmtime_r(&seconds, &time);
+                std::cout << std::put_time(&time, "%Y-%m-%d %H:%M:%S") << '.' << std::setfill('0') << std::setw(9)
+                          << nanoseconds << " [" << message.thread_id << "] ["
+                          << common_library::concurrency::logLevelName(message.level) << "] " << message.text << '\n';
+            }
+        }
+        catch (const std::exception &exception)
+        {
+            std::cerr << argv[i] << ": " << exception.what() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}